@@ -0,0 +1,118 @@
+#!/usr/bin/env python3
+# generates synthetic stress-maps for the headless benchmark (lop_headless)
+# usage: python3 bench/stress_maps.py [OUT_DIR] (default build/bench, the bench target makes them there)
+#
+#   stress.tmj - 128x128, 4000 objects (an even mix of loot, traps, chests, followers & avoiders)
+#   crowd.tmj - 96x96, 10000 objects (mostly followers/avoiders, so simulation & collision dominate)
+#   huge.tmj  - 384x384, 3 big tile-layers (with animated water) & a few objects, so loading & drawing dominate
+
+import json
+import os
+import random
+import sys
+
+TILESET = os.path.join(os.path.dirname(os.path.abspath(__file__)), "..", "assets", "sprites.tsj")
+
+# gids from sprites.tsj
+WATER = 175
+LAND = [184, 185, 186, 253, 255]
+WALL = 254
+ENEMIES = [37, 49, 73, 85]
+LOOT = 192
+TRAP = 157
+CHEST = 101
+
+
+def tile_layer(layer_id, name, width, height, data):
+    return {"data": data, "height": height, "id": layer_id, "name": name, "opacity": 1, "type": "tilelayer", "visible": True, "width": width, "x": 0, "y": 0}
+
+
+def obj(obj_id, gid, x, y, type_="", name="", properties=None):
+    o = {"gid": gid, "height": 16, "id": obj_id, "name": name, "rotation": 0, "type": type_, "visible": True, "width": 16, "x": x, "y": y}
+    if properties:
+        o["properties"] = properties
+    return o
+
+
+def random_object(rng, obj_id, width, height):
+    # tile-objects are positioned by bottom-left
+    x = rng.randrange(1, width - 1) * 16
+    y = rng.randrange(2, height) * 16
+    kind = rng.random()
+    if kind < 0.6:
+        follow = rng.random() < 0.7
+        return obj(obj_id, rng.choice(ENEMIES), x, y, "enemy", properties=[
+            {"name": "avoid", "type": "bool", "value": not follow},
+            {"name": "follow", "type": "bool", "value": follow},
+        ])
+    if kind < 0.75:
+        return obj(obj_id, LOOT, x, y, "loot", properties=[{"name": "sound", "type": "string", "value": "coin"}, {"name": "value", "type": "int", "value": 1}])
+    if kind < 0.9:
+        return obj(obj_id, TRAP, x, y, "trap", properties=[{"name": "value", "type": "int", "value": 1}])
+    return obj(obj_id, CHEST, x, y, "chest", properties=[{"name": "value", "type": "int", "value": 5}])
+
+
+# every kind of object equally, for the object-grid (collision) & contacts
+def even_object(rng, obj_id, width, height):
+    x = rng.randrange(1, width - 1) * 16
+    y = rng.randrange(2, height) * 16
+    kind = rng.randrange(5)
+    if kind == 0:
+        return obj(obj_id, LOOT, x, y, "loot", properties=[{"name": "sound", "type": "string", "value": "coin"}, {"name": "value", "type": "int", "value": 1}])
+    if kind == 1:
+        return obj(obj_id, TRAP, x, y, "trap")
+    if kind == 2:
+        return obj(obj_id, CHEST, x, y, "chest", properties=[{"name": "value", "type": "int", "value": 5}])
+    if kind == 3:
+        return obj(obj_id, rng.choice(ENEMIES), x, y, "enemy", properties=[{"name": "follow", "type": "bool", "value": True}])
+    return obj(obj_id, rng.choice(ENEMIES), x, y, "enemy", properties=[{"name": "avoid", "type": "bool", "value": True}])
+
+
+def make_map(filename, width, height, object_count, water, walls, seed, object_fn=random_object):
+    rng = random.Random(seed)
+    tileset = os.path.relpath(TILESET, os.path.dirname(os.path.abspath(filename))).replace(os.sep, "/")
+    size = width * height
+
+    water_data = [WATER if rng.random() < water else 0 for _ in range(size)]
+    land_data = [0 if water_data[i] else rng.choice(LAND) for i in range(size)]
+    collision_data = [0] * size
+    for y in range(height):
+        for x in range(width):
+            border = x == 0 or y == 0 or x == width - 1 or y == height - 1
+            if border or rng.random() < walls:
+                collision_data[y * width + x] = WALL
+
+    # keep the middle clear, for the player
+    cx, cy = width // 2, height // 2
+    for y in range(cy - 2, cy + 3):
+        for x in range(cx - 2, cx + 3):
+            collision_data[y * width + x] = 0
+
+    objects = [obj(1, 1, cx * 16, (cy + 1) * 16, name="player")]
+    for i in range(object_count):
+        objects.append(object_fn(rng, i + 2, width, height))
+
+    # no water, no water-layer
+    layers = [tile_layer(1, "water_anim", width, height, water_data)] if water > 0 else []
+    layers += [
+        tile_layer(2, "land", width, height, land_data),
+        {"draworder": "topdown", "id": 3, "class": "ysort", "name": "objects", "objects": objects, "opacity": 1, "type": "objectgroup", "visible": True, "x": 0, "y": 0},
+        tile_layer(4, "collisions", width, height, collision_data),
+    ]
+
+    tiled = {
+        "backgroundcolor": "#6dc2ca", "compressionlevel": -1, "height": height, "infinite": False, "layers": layers,
+        "nextlayerid": 5, "nextobjectid": object_count + 2, "orientation": "orthogonal", "renderorder": "right-down",
+        "tiledversion": "1.11.2", "tileheight": 16, "tilesets": [{"firstgid": 1, "source": tileset}], "tilewidth": 16,
+        "type": "map", "version": "1.10", "width": width,
+    }
+    with open(filename, "w") as f:
+        json.dump(tiled, f, separators=(",", ":"))
+
+
+if __name__ == "__main__":
+    out = sys.argv[1] if len(sys.argv) > 1 else "build/bench"
+    os.makedirs(out, exist_ok=True)
+    make_map(os.path.join(out, "stress.tmj"), 128, 128, 4000, water=0, walls=0.03, seed=3, object_fn=even_object)
+    make_map(os.path.join(out, "crowd.tmj"), 96, 96, 10000, water=0.1, walls=0.03, seed=1)
+    make_map(os.path.join(out, "huge.tmj"), 384, 384, 500, water=0.4, walls=0.02, seed=2)
@@ -15,50 +15,420 @@
 #define ABS(x) ((x) < 0 ? -(x) : (x))
 #endif
 
-// pop from front of LL
-#ifndef LL_POP
-#define LL_POP(head, node) do { (node) = (head); if (head) (head) = (head)->next; } while(0)
+// simple collision
+#ifndef RECTS_OVERLAP
+#define RECTS_OVERLAP(ax, ay, aw, ah, bx, by, bw, bh) ((ax) < (bx) + (bw) && (ax) + (aw) > (bx) && (ay) < (by) + (bh) && (ay) + (ah) > (by))
 #endif
 
-// push to front of LL
-#ifndef LL_PUSH
-#define LL_PUSH(head, node) do { (node)->next = (head); (head) = (node); } while(0)
+#if !defined(__EMSCRIPTEN__) && !defined(_WIN32)
+#define ADVENTURE_MMAP
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
 #endif
 
-// simple collision
-#ifndef RECTS_OVERLAP
-#define RECTS_OVERLAP(ax, ay, aw, ah, bx, by, bw, bh) ((ax) < (bx) + (bw) && (ax) + (aw) > (bx) && (ay) < (by) + (bh) && (ay) + (ah) > (by))
+// timing hooks around simulation (SIM, COMMANDS, MOVE, NPC, INTENTS), collision-checks (COLLISION), animation (ANIMATE),
+// drawing (DRAW) & map-loading (LOAD), empty unless something (profiler.h, tools/headless.c) defines them
+#ifndef ADVENTURE_ZONE_BEGIN
+#define ADVENTURE_ZONE_BEGIN(zone)
+#define ADVENTURE_ZONE_END(zone)
+#endif
+
+#include "arena.h"
+#include "asset_cache.h"
+#ifndef ADVENTURE_BAKE_ERROR
+#define ADVENTURE_BAKE_ERROR(...) pntr_app_log_ex(PNTR_APP_LOG_ERROR, __VA_ARGS__)
+#endif
+#include "adventure_bake.h"
+#include "adventure_random.h"
+#include "adventure_entities.h"
+#include "adventure_anim.h"
+#include "adventure_blit.h"
+
+// a single cell of the object-grid: every entity whose rect touches this tile
+typedef struct adventure_grid_cell_t {
+    int* entities;
+    int count;
+    int capacity;
+} adventure_grid_cell_t;
+
+// cell-range an entity was last inserted at (inclusive)
+typedef struct adventure_grid_span_t {
+    int x0, y0, x1, y1;
+    bool inserted;
+} adventure_grid_span_t;
+
+// uniform grid (one cell per map-tile) so object-collision only looks at nearby objects
+// objects outside the map are clamped into the edge cells
+typedef struct adventure_grid_t {
+    int width;
+    int height;
+    int cell_width;
+    int cell_height;
+    adventure_grid_cell_t* cells;
+
+    // indexed by entity, so we know which cells to remove an entity from when it moves
+    adventure_grid_span_t* spans;
+    int span_count;
+
+    arena_t* arena;     // the map's, cells that fill up grow into it
+} adventure_grid_t;
+
+// collision-layer packed into 1 bit per tile (any non-zero gid is solid)
+// so "is there a wall in this rect" is a couple of word-compares per row
+typedef struct adventure_collision_t {
+    uint32_t* bits;
+    int width;          // in tiles
+    int height;         // in tiles
+    int words_per_row;
+    int tilewidth;
+    int tileheight;
+} adventure_collision_t;
+
+// result of moving a box through the collision-layer (adventure_sweep)
+typedef struct adventure_sweep_t {
+    float x;            // where it ends up (top-left)
+    float y;
+    float time;         // how much of the move it made before it first hit a wall (0-1, on that axis), 1 if it hit nothing
+    int normal_x;       // which way the wall it hit on each axis faces (-1, 1), 0 if that axis was not blocked
+    int normal_y;
+    bool hit;
+} adventure_sweep_t;
+
+// tiles a flow-field has no distance for (walls, unreachable, or further than its range)
+#define ADVENTURE_NAV_FAR 0xFFFF
+
+// path-finding over the collision-layer: 1 node per tile, 4 neighbours (NPCs move on 1 axis at a time)
+// the flow-field is BFS distance (in tiles) to a goal-tile, and is only rebuilt when the goal moves to another tile
+// (or a collision-tile changes), so any number of followers share it & each of them just looks at 4 neighbours
+// distance/mark are generation-stamped, so a rebuild only touches the tiles it reaches
+typedef struct adventure_nav_t {
+    int width;              // in tiles
+    int height;
+    int goal_x;             // tile the field leads to (-1 if not built)
+    int goal_y;
+    int range;              // field was built this many tiles out from goal (0 = whole map)
+    bool dirty;             // collisions changed, rebuild on next update
+    uint16_t* distance;     // per tile, only valid where mark == generation
+    uint32_t* mark;
+    uint32_t generation;
+    int* queue;
+
+    // A* scratch (adventure_nav_path), allocated the first time it's used
+    uint32_t* cost;
+    uint32_t* search_mark;
+    uint32_t search_generation;
+    int* parent;
+    int* heap;
+    int* heap_pos;
+
+    arena_t* arena;         // the map's
+} adventure_nav_t;
+
+// a tileset-image, and its animations (shared with other maps that use it)
+typedef struct adventure_tileset_t {
+    const adventure_bake_tileset_t* baked;
+    pntr_image* image;
+    adventure_anim_table_t* anim;   // NULL if it has none
+    uint8_t* blit;                  // per local tile-index: adventure_blit_kind_t, classified the first time it's drawn
+} adventure_tileset_t;
+
+// a layer, drawn in order
+typedef struct adventure_layer_t {
+    const adventure_bake_layer_t* baked;
+    const char* name;
+    bool visible;
+    bool ysort;         // class "ysort": objects are drawn by their bottom edge, so lower ones overlap higher ones
+    uint16_t* gids;     // in place in the blob (NULL for object-layers)
+} adventure_layer_t;
+
+// entities on screen, in the order they are drawn
+// it's kept between frames (order barely changes) so it's re-sorted with an insertion-sort
+typedef struct adventure_drawlist_t {
+    int* entities;
+    int count;
+    uint32_t* stamp;    // per entity: 2*frame if on screen this frame, 2*frame+1 once it's in the list
+    uint32_t frame;
+} adventure_drawlist_t;
+
+// size of a pre-drawn chunk of static tiles, in pixels
+#ifndef ADVENTURE_CHUNK_SIZE
+#define ADVENTURE_CHUNK_SIZE 256
 #endif
 
-// linked list
-// this allows you to use to use as a single-map or list of preloaded maps
+// chunk-images more than this many chunks away from the ones on screen are freed (& re-drawn if they come back)
+#ifndef ADVENTURE_CHUNK_MARGIN
+#define ADVENTURE_CHUNK_MARGIN 1
+#endif
+
+// static tiles of a run of tile-layers (the ones between object-layers), pre-drawn into chunk-images
+// so a frame is a few chunk-blits, plus animated tiles on top
+// chunks are drawn the first time they are on screen, so only the part of the map near the camera has images
+typedef struct adventure_chunks_t {
+    int first_layer;    // inclusive range of layers
+    int last_layer;
+    int columns;        // in chunks
+    int rows;
+    int chunk_tiles_x;  // map-tiles per chunk
+    int chunk_tiles_y;
+    pntr_image** images;    // NULL if the chunk has no static tiles
+    bool* dirty;            // re-draw chunk before next use
+    uint8_t* dynamic;       // per map-tile: 1 if any layer in the run has an animated tile there, those are drawn every frame
+    uint8_t* blit;          // per chunk: adventure_blit_kind_t of its image (most are all ground, so OPAQUE)
+    int view_x0;            // chunks that were on screen the last time it was drawn (inclusive), -1 if never
+    int view_y0;
+    int view_x1;
+    int view_y1;
+} adventure_chunks_t;
+
+// a tile changed by adventure_set_tile: layer & index (in the blob's tile-data, so it's unique across layers) & what it is now
+typedef struct adventure_tile_edit_t {
+    uint32_t tile;
+    uint16_t layer;
+    uint16_t gid;
+} adventure_tile_edit_t;
+
+// everything about a map that changes while playing: objects (where they are, how they look, their random-streams) & changed tiles
+// take one (adventure_snapshot_take) to go back to it later, the map keeps one from when it loaded (adventure_map_reset)
+typedef struct adventure_snapshot_t {
+    int count;          // entities
+    float* x;
+    float* y;
+    int* gid;
+    bool* visible;
+    adventure_random_t* random;
+    float* speed;
+    int* awareness;
+    adventure_tile_edit_t* edits;   // every tile that is not what was baked
+    int edit_count;
+} adventure_snapshot_t;
+
+// a single loaded map
+// it's a baked blob (see adventure_bake.h), used in place, plus runtime state
+// keep these in an asset_cache_t (see adventure_load) to use as a single-map or list of preloaded maps
 typedef struct adventure_map_t {
-    cute_tiled_map_t* map;
-    cute_tiled_object_t* player;
-    cute_tiled_layer_t* layer_objects;
-    cute_tiled_layer_t* layer_collisions;
-    struct adventure_map_t* next;
+    unsigned char* blob;
+    size_t blob_size;
+    bool blob_mapped;   // mmap'd (instead of in memory)
+    const adventure_bake_header_t* header;
+
+    adventure_layer_t* layers;
+    int layer_count;
+    int layer_objects;      // index, or -1
+    int layer_collisions;   // index, or -1
+
+    adventure_tileset_t* tilesets;
+    int tileset_count;
+    float alpha;            // how far between the last 2 simulation-ticks to draw objects (1 = where they are now)
+
+    adventure_chunks_t* chunks;
+    int chunk_count;
+
+    adventure_drawlist_t drawlist;
+
+    adventure_entities_t entities;
+    adventure_grid_t grid;
+    adventure_collision_t collision;
+    adventure_nav_t nav;
     char* filename;
+    asset_cache_t* cache;   // the cache it was loaded into (by adventure_cache_load), told when chunk-images come & go
+
+    // tile-changes: the tile-data as it was baked (copied on the first change), & which tiles have changed since
+    uint16_t* tiles_baked;
+    uint32_t* tiles_edited;     // 1 bit per tile in tile-data
+    adventure_tile_edit_t* edits;
+    int edit_count;
+    int edit_capacity;
+
+    // state right after loading, for adventure_map_reset
+    adventure_snapshot_t initial;
+
+    // everything above (and the map itself) is allocated in this, except images & the blob, so unloading is 1 reset
+    arena_t arena;
 } adventure_map_t;
 
-// called when anythign touches wall or other object
-typedef void (*AdventureCollisionCallback)(pntr_app* app, adventure_map_t* mapContainer, cute_tiled_object_t* subject, cute_tiled_object_t* object);
+// called when anything touches a wall (objects are tracked by adventure_contacts_t)
+// subject is an entity-index in mapContainer->entities, object is -1 for static geometry
+typedef void (*AdventureCollisionCallback)(pntr_app* app, adventure_map_t* mapContainer, int subject, int object);
+
+
+// get the cell-range a rect covers, clamped to the grid
+static void adventure_grid_span(adventure_grid_t* grid, float x, float y, float width, float height, adventure_grid_span_t* span) {
+    span->x0 = MIN(MAX((int)floorf(x / grid->cell_width), 0), grid->width - 1);
+    span->y0 = MIN(MAX((int)floorf(y / grid->cell_height), 0), grid->height - 1);
+    span->x1 = MIN(MAX((int)floorf((x + MAX(width, 1) - 1) / grid->cell_width), 0), grid->width - 1);
+    span->y1 = MIN(MAX((int)floorf((y + MAX(height, 1) - 1) / grid->cell_height), 0), grid->height - 1);
+}
+
+// the old array is left in the arena, it doubles each time so that's never more than the cell uses now
+static void adventure_grid_cell_add(adventure_grid_t* grid, adventure_grid_cell_t* cell, int e) {
+    if (cell->count == cell->capacity) {
+        int capacity = cell->capacity ? cell->capacity * 2 : 4;
+        int* entities = arena_alloc(grid->arena, sizeof(int) * capacity);
+        if (cell->entities != NULL) {
+            memcpy(entities, cell->entities, sizeof(int) * cell->count);
+        }
+        cell->entities = entities;
+        cell->capacity = capacity;
+    }
+    cell->entities[cell->count++] = e;
+}
+
+// swap-remove, order inside a cell does not matter
+static void adventure_grid_cell_remove(adventure_grid_cell_t* cell, int e) {
+    for (int i = 0; i < cell->count; i++) {
+        if (cell->entities[i] == e) {
+            cell->entities[i] = cell->entities[--cell->count];
+            return;
+        }
+    }
+}
 
+// put an entity into the grid, or move it to new cells if it has moved
+// call this whenever you change entity x/y/width/height
+void adventure_grid_update(adventure_grid_t* grid, adventure_entities_t* entities, int e) {
+    if (grid == NULL || grid->cells == NULL || entities == NULL || e < 0 || e >= grid->span_count) {
+        return;
+    }
+    adventure_grid_span_t* old = &grid->spans[e];
+    adventure_grid_span_t span = {0};
+    adventure_grid_span(grid, entities->x[e], entities->y[e], entities->width[e], entities->height[e], &span);
+    span.inserted = true;
+
+    if (old->inserted && old->x0 == span.x0 && old->y0 == span.y0 && old->x1 == span.x1 && old->y1 == span.y1) {
+        return;
+    }
+
+    if (old->inserted) {
+        for (int cy = old->y0; cy <= old->y1; cy++) {
+            for (int cx = old->x0; cx <= old->x1; cx++) {
+                adventure_grid_cell_remove(&grid->cells[cy * grid->width + cx], e);
+            }
+        }
+    }
+    for (int cy = span.y0; cy <= span.y1; cy++) {
+        for (int cx = span.x0; cx <= span.x1; cx++) {
+            adventure_grid_cell_add(grid, &grid->cells[cy * grid->width + cx], e);
+        }
+    }
+    *old = span;
+}
+
+// build the grid for all entities (in arena)
+void adventure_grid_build(adventure_grid_t* grid, arena_t* arena, const adventure_bake_header_t* map, adventure_entities_t* entities) {
+    if (grid == NULL || map == NULL || entities == NULL) {
+        return;
+    }
+    grid->arena = arena;
+    grid->width = MAX(map->width, 1);
+    grid->height = MAX(map->height, 1);
+    grid->cell_width = MAX(map->tilewidth, 1);
+    grid->cell_height = MAX(map->tileheight, 1);
+    grid->cells = arena_alloc(arena, sizeof(adventure_grid_cell_t) * grid->width * grid->height);
+    grid->span_count = entities->count;
+    grid->spans = arena_alloc(arena, sizeof(adventure_grid_span_t) * MAX(grid->span_count, 1));
 
-// check tiles (on a tile layer) around an object
-// any tile on collision-layer will trigger a hit
-bool adventure_check_static_collision(cute_tiled_map_t* map, cute_tiled_layer_t* layer, const pntr_rectangle* rect){
-    if (map == NULL || layer == NULL || rect == NULL ) {
+    // count what starts in each cell, so all cells share 1 array with exactly enough room
+    int total = 0;
+    for (int e = 0; e < entities->count; e++) {
+        adventure_grid_span_t span = {0};
+        adventure_grid_span(grid, entities->x[e], entities->y[e], entities->width[e], entities->height[e], &span);
+        for (int cy = span.y0; cy <= span.y1; cy++) {
+            for (int cx = span.x0; cx <= span.x1; cx++) {
+                grid->cells[cy * grid->width + cx].capacity++;
+                total++;
+            }
+        }
+    }
+    int* cell_entities = arena_alloc(arena, sizeof(int) * MAX(total, 1));
+    for (int i = 0; i < grid->width * grid->height; i++) {
+        if (grid->cells[i].capacity > 0) {
+            grid->cells[i].entities = cell_entities;
+            cell_entities += grid->cells[i].capacity;
+        }
+    }
+
+    for (int e = 0; e < entities->count; e++) {
+        adventure_grid_update(grid, entities, e);
+    }
+}
+
+// pack a collision tile-layer into bits (in arena)
+void adventure_collision_build(adventure_collision_t* collision, arena_t* arena, const adventure_bake_header_t* map, adventure_layer_t* layer) {
+    if (collision == NULL || map == NULL || layer == NULL || layer->gids == NULL) {
+        return;
+    }
+    int width = layer->baked->width;
+    int height = layer->baked->height;
+    collision->width = width;
+    collision->height = height;
+    collision->tilewidth = MAX(map->tilewidth, 1);
+    collision->tileheight = MAX(map->tileheight, 1);
+    collision->words_per_row = (width + 31) / 32;
+
+    size_t size = sizeof(uint32_t) * collision->words_per_row * MAX(collision->height, 1);
+    collision->bits = arena_alloc(arena, size);
+
+    for (int ty = 0; ty < height; ty++) {
+        uint32_t* row = collision->bits + ty * collision->words_per_row;
+        const uint16_t* gids = layer->gids + ty * width;
+        for (int tx = 0; tx < width; tx++) {
+            if (gids[tx] != 0) {
+                row[tx >> 5] |= 1u << (tx & 31);
+            }
+        }
+    }
+}
+
+// is a single tile solid? (outside the map is not)
+bool adventure_collision_solid(adventure_collision_t* collision, int tx, int ty) {
+    if (collision == NULL || collision->bits == NULL || tx < 0 || ty < 0 || tx >= collision->width || ty >= collision->height) {
         return false;
     }
-    int tile_x0 = MAX((int)(rect->x) / map->tilewidth, 0);
-    int tile_y0 = MAX((int)(rect->y) / map->tileheight, 0);
-    int tile_x1 = MIN((int)((rect->x + rect->width  - 1)) / map->tilewidth, layer->width - 1);
-    int tile_y1 = MIN((int)((rect->y + rect->height - 1)) / map->tileheight, layer->height);
-    for (int ty = tile_y0; ty <= tile_y1; ++ty) {
-        for (int tx = tile_x0; tx <= tile_x1; ++tx) {
-            int idx = (ty-1) * layer->width + tx;
-            if (idx >= 0 && idx < layer->data_count && layer->data[idx] != 0) {
+    return (collision->bits[ty * collision->words_per_row + (tx >> 5)] >> (tx & 31)) & 1u;
+}
+
+// change a single tile (if you edit the collision-layer at runtime)
+void adventure_collision_set(adventure_collision_t* collision, int tx, int ty, bool solid) {
+    if (collision == NULL || collision->bits == NULL || tx < 0 || ty < 0 || tx >= collision->width || ty >= collision->height) {
+        return;
+    }
+    uint32_t* word = &collision->bits[ty * collision->words_per_row + (tx >> 5)];
+    if (solid) {
+        *word |= 1u << (tx & 31);
+    } else {
+        *word &= ~(1u << (tx & 31));
+    }
+}
+
+// is any tile in this (inclusive) tile-range solid? tested a word (32 tiles) at a time
+bool adventure_collision_any(adventure_collision_t* collision, int tile_x0, int tile_y0, int tile_x1, int tile_y1) {
+    if (collision == NULL || collision->bits == NULL) {
+        return false;
+    }
+    tile_x0 = MAX(tile_x0, 0);
+    tile_y0 = MAX(tile_y0, 0);
+    tile_x1 = MIN(tile_x1, collision->width - 1);
+    tile_y1 = MIN(tile_y1, collision->height - 1);
+    if (tile_x0 > tile_x1 || tile_y0 > tile_y1) {
+        return false;
+    }
+    int word0 = tile_x0 >> 5;
+    int word1 = tile_x1 >> 5;
+    uint32_t mask0 = ~0u << (tile_x0 & 31);
+    uint32_t mask1 = ~0u >> (31 - (tile_x1 & 31));
+    for (int ty = tile_y0; ty <= tile_y1; ty++) {
+        uint32_t* row = collision->bits + ty * collision->words_per_row;
+        for (int w = word0; w <= word1; w++) {
+            uint32_t mask = ~0u;
+            if (w == word0) {
+                mask &= mask0;
+            }
+            if (w == word1) {
+                mask &= mask1;
+            }
+            if (row[w] & mask) {
                 return true;
             }
         }
@@ -66,18 +436,424 @@ bool adventure_check_static_collision(cute_tiled_map_t* map, cute_tiled_layer_t*
     return false;
 }
 
+// check tiles (on collision-layer) under a world-space rect
+// any tile on collision-layer will trigger a hit, outside the map does not
+bool adventure_check_static_collision(adventure_collision_t* collision, const pntr_rectangle* rect){
+    if (collision == NULL || collision->bits == NULL || rect == NULL ) {
+        return false;
+    }
+    int tile_x0 = (int)floorf((float)rect->x / collision->tilewidth);
+    int tile_y0 = (int)floorf((float)rect->y / collision->tileheight);
+    int tile_x1 = (int)floorf((float)(rect->x + rect->width  - 1) / collision->tilewidth);
+    int tile_y1 = (int)floorf((float)(rect->y + rect->height - 1) / collision->tileheight);
+    ADVENTURE_ZONE_BEGIN(COLLISION);
+    bool hit = adventure_collision_any(collision, tile_x0, tile_y0, tile_x1, tile_y1);
+    ADVENTURE_ZONE_END(COLLISION);
+    return hit;
+}
 
-// check if any objects (on a layer) collide with an object & retiurn first that does
-cute_tiled_object_t* adventure_check_object_collision(cute_tiled_layer_t* layer, const pntr_rectangle* rect, cute_tiled_object_t* subject){
-    if (subject == NULL || rect == NULL || layer == NULL) {
-        return NULL;
+// move a box along 1 axis a tile-column (or row) at a time, & stop against the first solid one
+// only tiles it moves into count, so something already in a wall can still get out
+// cross0/cross1 is the (inclusive) range of rows (or columns) it covers, returns how far it got
+static float adventure_sweep_axis(adventure_collision_t* collision, bool vertical, float pos, float size, float move, int tile, int cross0, int cross1, int* normal) {
+    *normal = 0;
+    int count = vertical ? collision->height : collision->width;
+    if (move > 0) {
+        int first = MAX((int)ceilf((pos + size) / tile), 0);
+        int last = MIN((int)ceilf((pos + size + move) / tile) - 1, count - 1);
+        for (int t = first; t <= last; t++) {
+            if (vertical ? adventure_collision_any(collision, cross0, t, cross1, t) : adventure_collision_any(collision, t, cross0, t, cross1)) {
+                *normal = -1;
+                return fmaxf(t * tile - size - pos, 0);
+            }
+        }
+    } else if (move < 0) {
+        int first = MIN((int)floorf(pos / tile) - 1, count - 1);
+        int last = MAX((int)floorf((pos + move) / tile), 0);
+        for (int t = first; t >= last; t--) {
+            if (vertical ? adventure_collision_any(collision, cross0, t, cross1, t) : adventure_collision_any(collision, t, cross0, t, cross1)) {
+                *normal = 1;
+                return fminf((t + 1) * tile - pos, 0);
+            }
+        }
+    }
+    return move;
+}
+
+// move a box (x/y/w/h, world-space) by move_x/move_y through the collision-layer: x first, then y from there
+// it stops against walls on each axis separately (so it slides along them) & can't skip through thin ones, however far it moves
+// it only reads, so it's safe to run for many objects at once. returns true if it hit a wall
+bool adventure_sweep(adventure_collision_t* collision, float x, float y, float w, float h, float move_x, float move_y, adventure_sweep_t* sweep) {
+    memset(sweep, 0, sizeof(adventure_sweep_t));
+    sweep->time = 1;
+    if (collision == NULL || collision->bits == NULL) {
+        sweep->x = x + move_x;
+        sweep->y = y + move_y;
+        return false;
+    }
+    ADVENTURE_ZONE_BEGIN(COLLISION);
+    int tw = collision->tilewidth;
+    int th = collision->tileheight;
+    w = fmaxf(w, 1);
+    h = fmaxf(h, 1);
+
+    float moved_x = adventure_sweep_axis(collision, false, x, w, move_x, tw, (int)floorf(y / th), (int)ceilf((y + h) / th) - 1, &sweep->normal_x);
+    sweep->x = x + moved_x;
+    float moved_y = adventure_sweep_axis(collision, true, y, h, move_y, th, (int)floorf(sweep->x / tw), (int)ceilf((sweep->x + w) / tw) - 1, &sweep->normal_y);
+    sweep->y = y + moved_y;
+
+    if (sweep->normal_x != 0) {
+        sweep->time = moved_x / move_x;
     }
-    for (cute_tiled_object_t* obj = layer->objects; obj; obj = obj->next) {
-        if (obj->visible && obj->id != subject->id && RECTS_OVERLAP(rect->x, rect->y, rect->width, rect->height, obj->x, obj->y, obj->width, obj->height)) {
-            return obj;
+    if (sweep->normal_y != 0) {
+        sweep->time = fminf(sweep->time, moved_y / move_y);
+    }
+    sweep->hit = sweep->normal_x != 0 || sweep->normal_y != 0;
+    ADVENTURE_ZONE_END(COLLISION);
+    return sweep->hit;
+}
+
+// sweep an entity (or a hitbox in it, relative to its top-left) through the collision-layer
+// x/y in sweep is where the entity would end up (it isn't moved, use adventure_move_object_to)
+bool adventure_sweep_entity(adventure_map_t* maps, int e, const pntr_rectangle* hitbox, float move_x, float move_y, adventure_sweep_t* sweep) {
+    adventure_entities_t* entities = &maps->entities;
+    float offset_x = hitbox ? hitbox->x : 0;
+    float offset_y = hitbox ? hitbox->y : 0;
+    float w = hitbox ? hitbox->width : entities->width[e];
+    float h = hitbox ? hitbox->height : entities->height[e];
+    bool hit = adventure_sweep(&maps->collision, entities->x[e] + offset_x, entities->y[e] + offset_y, w, h, move_x, move_y, sweep);
+    sweep->x -= offset_x;
+    sweep->y -= offset_y;
+    return hit;
+}
+
+
+// check if any entities (in the grid) collide with a rect & return first that does (or -1)
+// only the cells the rect covers are checked
+int adventure_check_object_collision(adventure_grid_t* grid, adventure_entities_t* entities, const pntr_rectangle* rect, int subject){
+    if (rect == NULL || grid == NULL || grid->cells == NULL || entities == NULL) {
+        return -1;
+    }
+    ADVENTURE_ZONE_BEGIN(COLLISION);
+    int found = -1;
+    adventure_grid_span_t span = {0};
+    adventure_grid_span(grid, rect->x, rect->y, rect->width, rect->height, &span);
+    for (int cy = span.y0; cy <= span.y1 && found == -1; cy++) {
+        for (int cx = span.x0; cx <= span.x1 && found == -1; cx++) {
+            adventure_grid_cell_t* cell = &grid->cells[cy * grid->width + cx];
+            for (int i = 0; i < cell->count; i++) {
+                int e = cell->entities[i];
+                if (entities->visible[e] && e != subject && RECTS_OVERLAP(rect->x, rect->y, rect->width, rect->height, entities->x[e], entities->y[e], entities->width[e], entities->height[e])) {
+                    found = e;
+                    break;
+                }
+            }
         }
     }
-    return NULL;
+    ADVENTURE_ZONE_END(COLLISION);
+    return found;
+}
+
+// find every visible entity (but subject) that overlaps a rect, up to max of them, sorted by entity-index
+// returns how many were found
+int adventure_find_object_collisions(adventure_grid_t* grid, adventure_entities_t* entities, const pntr_rectangle* rect, int subject, int* found, int max) {
+    if (rect == NULL || grid == NULL || grid->cells == NULL || entities == NULL || found == NULL) {
+        return 0;
+    }
+    ADVENTURE_ZONE_BEGIN(COLLISION);
+    int count = 0;
+    adventure_grid_span_t span = {0};
+    adventure_grid_span(grid, rect->x, rect->y, rect->width, rect->height, &span);
+    for (int cy = span.y0; cy <= span.y1; cy++) {
+        for (int cx = span.x0; cx <= span.x1; cx++) {
+            adventure_grid_cell_t* cell = &grid->cells[cy * grid->width + cx];
+            for (int i = 0; i < cell->count; i++) {
+                int e = cell->entities[i];
+                if (!entities->visible[e] || e == subject || !RECTS_OVERLAP(rect->x, rect->y, rect->width, rect->height, entities->x[e], entities->y[e], entities->width[e], entities->height[e])) {
+                    continue;
+                }
+
+                // insert in order (it's a handful), an entity in more than 1 cell is only added once
+                int at = count;
+                while (at > 0 && found[at - 1] > e) {
+                    at--;
+                }
+                if ((at > 0 && found[at - 1] == e) || at >= max) {
+                    continue;
+                }
+                if (count == max) {
+                    count--;
+                }
+                memmove(found + at + 1, found + at, sizeof(int) * (count - at));
+                found[at] = e;
+                count++;
+            }
+        }
+    }
+    ADVENTURE_ZONE_END(COLLISION);
+    return count;
+}
+
+// set up flow-field for a map's collisions (nothing to do if it has none), in arena
+void adventure_nav_init(adventure_nav_t* nav, arena_t* arena, adventure_collision_t* collision) {
+    memset(nav, 0, sizeof(adventure_nav_t));
+    nav->arena = arena;
+    nav->goal_x = -1;
+    nav->goal_y = -1;
+    if (collision == NULL || collision->bits == NULL || collision->width <= 0 || collision->height <= 0) {
+        return;
+    }
+    int count = collision->width * collision->height;
+    nav->width = collision->width;
+    nav->height = collision->height;
+    nav->distance = arena_alloc(arena, sizeof(uint16_t) * count);
+    nav->mark = arena_alloc(arena, sizeof(uint32_t) * count);
+    nav->queue = arena_alloc(arena, sizeof(int) * count);
+}
+
+// next stamp-generation, clearing the marks when it wraps
+static uint32_t adventure_nav_next_generation(uint32_t generation, uint32_t* mark, int count) {
+    if (++generation == 0) {
+        memset(mark, 0, sizeof(uint32_t) * count);
+        generation = 1;
+    }
+    return generation;
+}
+
+// point the flow-field at a goal-tile, out to range tiles (0 = whole map)
+// cheap to call every tick: it only re-runs the BFS if the goal changed tile, or collisions changed
+// returns true if it was rebuilt
+bool adventure_nav_update(adventure_nav_t* nav, adventure_collision_t* collision, int goal_x, int goal_y, int range) {
+    if (nav == NULL || nav->distance == NULL) {
+        return false;
+    }
+    if (!nav->dirty && goal_x == nav->goal_x && goal_y == nav->goal_y && range == nav->range) {
+        return false;
+    }
+    nav->dirty = false;
+    nav->goal_x = goal_x;
+    nav->goal_y = goal_y;
+    nav->range = range;
+
+    int width = nav->width;
+    int count = width * nav->height;
+    nav->generation = adventure_nav_next_generation(nav->generation, nav->mark, count);
+    if (goal_x < 0 || goal_y < 0 || goal_x >= width || goal_y >= nav->height || adventure_collision_solid(collision, goal_x, goal_y)) {
+        return true;
+    }
+
+    uint16_t limit = (range > 0 && range < ADVENTURE_NAV_FAR) ? (uint16_t)range : ADVENTURE_NAV_FAR - 1;
+    int head = 0;
+    int tail = 0;
+    int start = goal_y * width + goal_x;
+    nav->distance[start] = 0;
+    nav->mark[start] = nav->generation;
+    nav->queue[tail++] = start;
+
+    // each tile is queued once, so the queue never holds more than count
+    while (head < tail) {
+        int i = nav->queue[head++];
+        uint16_t d = nav->distance[i];
+        if (d >= limit) {
+            continue;
+        }
+        int tx = i % width;
+        int ty = i / width;
+        const int nx[4] = { tx, tx, tx - 1, tx + 1 };
+        const int ny[4] = { ty - 1, ty + 1, ty, ty };
+        for (int n = 0; n < 4; n++) {
+            if (nx[n] < 0 || ny[n] < 0 || nx[n] >= width || ny[n] >= nav->height) {
+                continue;
+            }
+            int j = ny[n] * width + nx[n];
+            if (nav->mark[j] == nav->generation || adventure_collision_solid(collision, nx[n], ny[n])) {
+                continue;
+            }
+            nav->mark[j] = nav->generation;
+            nav->distance[j] = d + 1;
+            nav->queue[tail++] = j;
+        }
+    }
+    return true;
+}
+
+// distance (in tiles, walking around walls) from a tile to the field's goal, or ADVENTURE_NAV_FAR
+uint16_t adventure_nav_distance(adventure_nav_t* nav, int tx, int ty) {
+    if (nav == NULL || nav->distance == NULL || tx < 0 || ty < 0 || tx >= nav->width || ty >= nav->height) {
+        return ADVENTURE_NAV_FAR;
+    }
+    int i = ty * nav->width + tx;
+    return nav->mark[i] == nav->generation ? nav->distance[i] : ADVENTURE_NAV_FAR;
+}
+
+// which neighbour to step to, to get closer to (towards=1) or further from (towards=0) the field's goal
+// returns false if there is no better neighbour (at the goal, cornered, or off the field)
+bool adventure_nav_step(adventure_nav_t* nav, int tx, int ty, int towards, int* dx, int* dy) {
+    uint16_t here = adventure_nav_distance(nav, tx, ty);
+    if (here == ADVENTURE_NAV_FAR) {
+        return false;
+    }
+    const int ox[4] = { 0, 0, -1, 1 };
+    const int oy[4] = { -1, 1, 0, 0 };
+    int best = -1;
+    uint16_t best_distance = here;
+    for (int n = 0; n < 4; n++) {
+        uint16_t d = adventure_nav_distance(nav, tx + ox[n], ty + oy[n]);
+        if (towards ? (d < best_distance) : (d != ADVENTURE_NAV_FAR && d > best_distance)) {
+            best = n;
+            best_distance = d;
+        }
+    }
+    if (best == -1) {
+        return false;
+    }
+    *dx = ox[best];
+    *dy = oy[best];
+    return true;
+}
+
+// A* priority of a tile: cost so far + manhattan distance to goal
+static inline uint32_t adventure_nav_priority(adventure_nav_t* nav, int i, int goal_x, int goal_y) {
+    return nav->cost[i] + ABS(i % nav->width - goal_x) + ABS(i / nav->width - goal_y);
+}
+
+// move a heap-entry up until its parent is not worse
+static void adventure_nav_heap_up(adventure_nav_t* nav, int pos, int goal_x, int goal_y) {
+    int i = nav->heap[pos];
+    uint32_t priority = adventure_nav_priority(nav, i, goal_x, goal_y);
+    while (pos > 0) {
+        int up = (pos - 1) / 2;
+        if (adventure_nav_priority(nav, nav->heap[up], goal_x, goal_y) <= priority) {
+            break;
+        }
+        nav->heap[pos] = nav->heap[up];
+        nav->heap_pos[nav->heap[pos]] = pos;
+        pos = up;
+    }
+    nav->heap[pos] = i;
+    nav->heap_pos[i] = pos;
+}
+
+// move a heap-entry down until its children are not better
+static void adventure_nav_heap_down(adventure_nav_t* nav, int pos, int size, int goal_x, int goal_y) {
+    int i = nav->heap[pos];
+    uint32_t priority = adventure_nav_priority(nav, i, goal_x, goal_y);
+    while (pos * 2 + 1 < size) {
+        int child = pos * 2 + 1;
+        if (child + 1 < size && adventure_nav_priority(nav, nav->heap[child + 1], goal_x, goal_y) < adventure_nav_priority(nav, nav->heap[child], goal_x, goal_y)) {
+            child++;
+        }
+        if (adventure_nav_priority(nav, nav->heap[child], goal_x, goal_y) >= priority) {
+            break;
+        }
+        nav->heap[pos] = nav->heap[child];
+        nav->heap_pos[nav->heap[pos]] = pos;
+        pos = child;
+    }
+    nav->heap[pos] = i;
+    nav->heap_pos[i] = pos;
+}
+
+// A* from one tile to another (for a single NPC with its own target, followers of the player should share the flow-field)
+// fills path with the tiles to walk through, as ty * width + tx (start not included, goal is last), up to max_path of them
+// returns the full length of the path (can be more than max_path), 0 if start is goal, -1 if there is no way there
+int adventure_nav_path(adventure_nav_t* nav, adventure_collision_t* collision, int start_x, int start_y, int goal_x, int goal_y, int* path, int max_path) {
+    if (nav == NULL || nav->distance == NULL) {
+        return -1;
+    }
+    int width = nav->width;
+    int count = width * nav->height;
+    if (start_x < 0 || start_y < 0 || start_x >= width || start_y >= nav->height || goal_x < 0 || goal_y < 0 || goal_x >= width || goal_y >= nav->height) {
+        return -1;
+    }
+    if (adventure_collision_solid(collision, goal_x, goal_y)) {
+        return -1;
+    }
+    int start = start_y * width + start_x;
+    int goal = goal_y * width + goal_x;
+    if (start == goal) {
+        return 0;
+    }
+
+    if (nav->cost == NULL) {
+        nav->cost = arena_alloc(nav->arena, sizeof(uint32_t) * count);
+        nav->search_mark = arena_alloc(nav->arena, sizeof(uint32_t) * count);
+        nav->parent = arena_alloc(nav->arena, sizeof(int) * count);
+        nav->heap = arena_alloc(nav->arena, sizeof(int) * count);
+        nav->heap_pos = arena_alloc(nav->arena, sizeof(int) * count);
+        nav->search_generation = 0;
+    }
+
+    // search_mark: 2*generation = seen (in heap), 2*generation+1 = closed
+    if (++nav->search_generation > 0x7FFFFFFF) {
+        memset(nav->search_mark, 0, sizeof(uint32_t) * count);
+        nav->search_generation = 1;
+    }
+    uint32_t seen = nav->search_generation * 2;
+    uint32_t closed = seen + 1;
+
+    nav->cost[start] = 0;
+    nav->parent[start] = -1;
+    nav->search_mark[start] = seen;
+    nav->heap[0] = start;
+    nav->heap_pos[start] = 0;
+    int size = 1;
+    bool found = false;
+
+    while (size > 0) {
+        int i = nav->heap[0];
+        nav->heap[0] = nav->heap[--size];
+        if (size > 0) {
+            nav->heap_pos[nav->heap[0]] = 0;
+            adventure_nav_heap_down(nav, 0, size, goal_x, goal_y);
+        }
+        nav->search_mark[i] = closed;
+        if (i == goal) {
+            found = true;
+            break;
+        }
+
+        int tx = i % width;
+        int ty = i / width;
+        const int nx[4] = { tx, tx, tx - 1, tx + 1 };
+        const int ny[4] = { ty - 1, ty + 1, ty, ty };
+        for (int n = 0; n < 4; n++) {
+            if (nx[n] < 0 || ny[n] < 0 || nx[n] >= width || ny[n] >= nav->height) {
+                continue;
+            }
+            int j = ny[n] * width + nx[n];
+            if (nav->search_mark[j] == closed || adventure_collision_solid(collision, nx[n], ny[n])) {
+                continue;
+            }
+            uint32_t cost = nav->cost[i] + 1;
+            if (nav->search_mark[j] != seen) {
+                nav->search_mark[j] = seen;
+                nav->cost[j] = cost;
+                nav->parent[j] = i;
+                nav->heap[size] = j;
+                adventure_nav_heap_up(nav, size++, goal_x, goal_y);
+            } else if (cost < nav->cost[j]) {
+                nav->cost[j] = cost;
+                nav->parent[j] = i;
+                adventure_nav_heap_up(nav, nav->heap_pos[j], goal_x, goal_y);
+            }
+        }
+    }
+
+    if (!found) {
+        return -1;
+    }
+
+    // walk back from goal, writing the first max_path steps in order
+    int length = (int)nav->cost[goal];
+    int step = length - 1;
+    for (int i = goal; i != start; i = nav->parent[i]) {
+        if (path != NULL && step < max_path) {
+            path[step] = i;
+        }
+        step--;
+    }
+    return length;
 }
 
 
@@ -91,189 +867,1088 @@ static float compute_axis_step(float obj_pos, float target_pos, float speed, int
     return 0.0f;
 }
 
-// move towards/away from object
-void adventure_move_object_relative_to_object(
-    cute_tiled_map_t* map,
-    cute_tiled_layer_t* collision_layer,
-    cute_tiled_object_t* obj,
-    float player_x,
-    float player_y,
-    float speed,        // pixels per frame
-    int towards         // 1 = move towards, 0 = move away
+// move x/y as far as it can go (see adventure_sweep)
+static void adventure_object_slide(adventure_collision_t* collision, float* x, float* y, float w, float h, float move_x, float move_y) {
+    adventure_sweep_t sweep;
+    adventure_sweep(collision, *x, *y, w, h, move_x, move_y, &sweep);
+    *x = sweep.x;
+    *y = sweep.y;
+}
+
+// the intent functions work out where an object wants to go, without changing anything
+// so they can run for many objects at once (on a job_pool_t) & the moves applied after, with adventure_move_object_to
+// x/y is where the object starts (usually its position) & is set to where it would end up
+
+// where an object would go, moving straight towards/away from a position (on its longest axis)
+// awareness is a radius in tiles (manhattan), -1 for any distance
+// returns false if it would not move
+bool adventure_object_intent_relative(
+    adventure_map_t* maps,
+    int e,
+    float target_x,
+    float target_y,
+    float speed,        // pixels per tick
+    int towards,        // 1 = move towards, 0 = move away
+    int awareness,
+    float* out_x,
+    float* out_y
 ) {
-    float dx = player_x - obj->x;
-    float dy = player_y - obj->y;
+    adventure_entities_t* entities = &maps->entities;
+    float x = *out_x;
+    float y = *out_y;
 
+    if (awareness >= 0) {
+        const adventure_bake_header_t* map = maps->header;
+        int obj_tile_x = (int)(x / map->tilewidth);
+        int obj_tile_y = (int)(y / map->tileheight);
+        int target_tile_x = (int)(target_x / map->tilewidth);
+        int target_tile_y = (int)(target_y / map->tileheight);
+        if (abs(target_tile_x - obj_tile_x) + abs(target_tile_y - obj_tile_y) > awareness) {
+            return false;
+        }
+    }
+
+    float dx = target_x - x;
+    float dy = target_y - y;
     float move_x = 0, move_y = 0;
 
     // Move in the axis with the greatest absolute distance
     if (fabsf(dx) > fabsf(dy)) {
-        move_x = compute_axis_step(obj->x, player_x, speed, towards);
+        move_x = compute_axis_step(x, target_x, speed, towards);
     } else if (fabsf(dy) > 0) {
-        move_y = compute_axis_step(obj->y, player_y, speed, towards);
+        move_y = compute_axis_step(y, target_y, speed, towards);
     }
 
-    // Try to move in the chosen direction
-    pntr_rectangle rect = { obj->x + move_x, obj->y + move_y, obj->width, obj->height };
-    if (!adventure_check_static_collision(map, collision_layer, &rect)) {
-        obj->x += move_x;
-        obj->y += move_y;
-    } else {
-        // Try moving only in x
-        pntr_rectangle rect_x = { obj->x + move_x, obj->y, obj->width, obj->height };
-        if (!adventure_check_static_collision(map, collision_layer, &rect_x)) {
-            obj->x += move_x;
-        } else {
-            // Try moving only in y
-            pntr_rectangle rect_y = { obj->x, obj->y + move_y, obj->width, obj->height };
-            if (!adventure_check_static_collision(map, collision_layer, &rect_y)) {
-                obj->y += move_y;
-            }
-        }
+    adventure_object_slide(&maps->collision, out_x, out_y, entities->width[e], entities->height[e], move_x, move_y);
+    return *out_x != x || *out_y != y;
+}
+
+// where an object would go, following the map's flow-field (see adventure_nav_update) towards/away from its goal, around walls
+// only moves if the object is within awareness tiles (walking distance) of the goal
+// once it's in the goal-tile it moves straight at target_x/target_y, like adventure_object_intent_relative
+// maps with no collision-layer have no flow-field, so this is adventure_object_intent_relative there
+bool adventure_object_intent_on_field(
+    adventure_map_t* maps,
+    int e,
+    float target_x,
+    float target_y,
+    float speed,        // pixels per tick
+    int towards,        // 1 = move towards, 0 = move away
+    int awareness,      // radius in tiles
+    float* out_x,
+    float* out_y
+) {
+    adventure_nav_t* nav = &maps->nav;
+    if (nav->distance == NULL) {
+        return adventure_object_intent_relative(maps, e, target_x, target_y, speed, towards, awareness, out_x, out_y);
+    }
+
+    adventure_entities_t* entities = &maps->entities;
+    int tw = maps->collision.tilewidth;
+    int th = maps->collision.tileheight;
+    float x = *out_x;
+    float y = *out_y;
+    float w = entities->width[e];
+    float h = entities->height[e];
+    int tx = (int)floorf((x + w / 2) / tw);
+    int ty = (int)floorf((y + h / 2) / th);
+
+    uint16_t distance = adventure_nav_distance(nav, tx, ty);
+    if (distance == ADVENTURE_NAV_FAR || distance > awareness) {
+        return false;
+    }
+    if (distance == 0 && towards) {
+        return adventure_object_intent_relative(maps, e, target_x, target_y, speed, towards, -1, out_x, out_y);
+    }
+
+    int dx = 0;
+    int dy = 0;
+    if (!adventure_nav_step(nav, tx, ty, towards, &dx, &dy)) {
+        return false;
+    }
+
+    // head for the middle of the next tile, so it lines up on the other axis & slides around corners
+    float goal_x = (tx + dx) * tw + (tw - w) / 2;
+    float goal_y = (ty + dy) * th + (th - h) / 2;
+    float move_x = fmaxf(-speed, fminf(speed, goal_x - x));
+    float move_y = fmaxf(-speed, fminf(speed, goal_y - y));
+
+    adventure_object_slide(&maps->collision, out_x, out_y, w, h, move_x, move_y);
+    return *out_x != x || *out_y != y;
+}
+
+// put an object somewhere (and update the object-grid)
+void adventure_move_object_to(adventure_map_t* maps, int e, float x, float y) {
+    adventure_entities_t* entities = &maps->entities;
+    if (x != entities->x[e] || y != entities->y[e]) {
+        entities->x[e] = x;
+        entities->y[e] = y;
+        adventure_grid_update(&maps->grid, entities, e);
+    }
+}
+
+// move towards/away from a position
+void adventure_move_object_relative_to_object(
+    adventure_map_t* maps,
+    int e,
+    float player_x,
+    float player_y,
+    float speed,        // pixels per tick
+    int towards         // 1 = move towards, 0 = move away
+) {
+    float x = maps->entities.x[e];
+    float y = maps->entities.y[e];
+    if (adventure_object_intent_relative(maps, e, player_x, player_y, speed, towards, -1, &x, &y)) {
+        adventure_move_object_to(maps, e, x, y);
     }
 }
 
 // same as adventure_move_object_relative_to_object, but has an awareness radius
 void adventure_move_object_relative_to_close_object(
-    cute_tiled_map_t* map,
-    cute_tiled_layer_t* collision_layer,
-    cute_tiled_object_t* obj,
+    adventure_map_t* maps,
+    int e,
     float player_x,
     float player_y,
     float speed,
     int towards,         // 1 = move towards, 0 = move away
     int awareness        // radius in tiles
 ) {
-    // Calculate tile positions
-    int obj_tile_x = (int)(obj->x / map->tilewidth);
-    int obj_tile_y = (int)(obj->y / map->tileheight);
-    int player_tile_x = (int)(player_x / map->tilewidth);
-    int player_tile_y = (int)(player_y / map->tileheight);
-
-    // Manhattan distance in tiles
-    int dx = abs(player_tile_x - obj_tile_x);
-    int dy = abs(player_tile_y - obj_tile_y);
-
-    if ((dx + dy) <= awareness) {
-        // Move only if within awareness radius
-        adventure_move_object_relative_to_object(
-            map,
-            collision_layer,
-            obj,
-            player_x,
-            player_y,
-            speed,
-            towards
-        );
-    }
-}
-
-
-// take a request for movement (after reading input) and fire callback on collision
-void adventure_try_to_move_player(pntr_app* app, adventure_map_t* maps, pntr_vector* req, pntr_rectangle* hitbox, AdventureCollisionCallback callback) {
-    if (maps == NULL || app == NULL) {
+    float x = maps->entities.x[e];
+    float y = maps->entities.y[e];
+    if (adventure_object_intent_relative(maps, e, player_x, player_y, speed, towards, MAX(awareness, 0), &x, &y)) {
+        adventure_move_object_to(maps, e, x, y);
+    }
+}
+
+// move towards/away from the goal of the map's flow-field, see adventure_object_intent_on_field
+void adventure_move_object_on_field(
+    adventure_map_t* maps,
+    int e,
+    float target_x,
+    float target_y,
+    float speed,        // pixels per tick
+    int towards,        // 1 = move towards, 0 = move away
+    int awareness       // radius in tiles
+) {
+    float x = maps->entities.x[e];
+    float y = maps->entities.y[e];
+    if (adventure_object_intent_on_field(maps, e, target_x, target_y, speed, towards, awareness, &x, &y)) {
+        adventure_move_object_to(maps, e, x, y);
+    }
+}
+
+// take a request for movement (after reading input) and fire callback if it hits a wall
+// touching objects is tracked by adventure_contacts_t (see adventure_contacts.h)
+// move_x/move_y are in pixels (fractions are kept, so slow or short steps still add up)
+void adventure_try_to_move_player(pntr_app* app, adventure_map_t* maps, float move_x, float move_y, pntr_rectangle* hitbox, AdventureCollisionCallback callback) {
+    if (maps == NULL || app == NULL || maps->entities.player == -1) {
         return;
     }
+    ADVENTURE_ZONE_BEGIN(MOVE);
 
-    float dt = pntr_app_delta_time(app);
+    int player = maps->entities.player;
 
-    // hitbox + position for collision
-    pntr_rectangle pos = {
-        req->x + maps->player->x + hitbox->x,
-        req->y +  maps->player->y + hitbox->y,
-        hitbox->width,
-        hitbox->height
-    };
+    // walls stop each axis separately, so it slides along them
+    adventure_sweep_t sweep;
+    if (adventure_sweep_entity(maps, player, hitbox, move_x, move_y, &sweep) && callback != NULL) {
+        callback(app, maps, player, -1);
+    }
+    adventure_move_object_to(maps, player, sweep.x, sweep.y);
+    ADVENTURE_ZONE_END(MOVE);
+}
 
-    bool collision_static = false;;
-    bool collision_objects = false;
+// background color of a map (black if it has none)
+pntr_color adventure_background(adventure_map_t* map) {
+    if (map == NULL || map->header->backgroundcolor == 0) {
+        return PNTR_BLACK;
+    }
+    return pntr_tiled_color(map->header->backgroundcolor);
+}
+
+void adventure_chunks_invalidate(adventure_map_t* map, int layer, int tx, int ty);
+
+// change a tile on a layer (0 to clear it), this also updates collisions & pre-drawn chunks
+// write a tile & update what depends on it (collision, flow-field, chunk), tx/ty must be on the layer
+static void adventure_tile_write(adventure_map_t* map, int layer, int tx, int ty, int gid) {
+    map->layers[layer].gids[ty * map->layers[layer].baked->width + tx] = (uint16_t)gid;
+    if (layer == map->layer_collisions) {
+        adventure_collision_set(&map->collision, tx, ty, gid != 0);
+        map->nav.dirty = true;
+    }
+    adventure_chunks_invalidate(map, layer, tx, ty);
+}
+
+// remember a tile is about to change from how it was baked (once per tile), so a snapshot/reset can find it
+static void adventure_tile_edited(adventure_map_t* map, int layer, uint32_t tile) {
+    if (map->tiles_baked == NULL) {
+        size_t count = map->header->tiledata_size / sizeof(uint16_t);
+        map->tiles_baked = arena_alloc(&map->arena, sizeof(uint16_t) * MAX(count, 1));
+        memcpy(map->tiles_baked, map->blob + map->header->tiledata_offset, sizeof(uint16_t) * count);
+        map->tiles_edited = arena_alloc(&map->arena, sizeof(uint32_t) * ((count + 31) / 32 + 1));
+    }
+    if (map->tiles_edited[tile >> 5] & (1u << (tile & 31))) {
+        return;
+    }
+    map->tiles_edited[tile >> 5] |= 1u << (tile & 31);
+    if (map->edit_count == map->edit_capacity) {
+        int capacity = map->edit_capacity ? map->edit_capacity * 2 : 32;
+        adventure_tile_edit_t* edits = arena_alloc(&map->arena, sizeof(adventure_tile_edit_t) * capacity);
+        if (map->edits != NULL) {
+            memcpy(edits, map->edits, sizeof(adventure_tile_edit_t) * map->edit_count);
+        }
+        map->edits = edits;
+        map->edit_capacity = capacity;
+    }
+    map->edits[map->edit_count++] = (adventure_tile_edit_t) { tile, (uint16_t)layer, 0 };
+}
+
+void adventure_set_tile(adventure_map_t* map, int layer, int tx, int ty, int gid) {
+    if (map == NULL || layer < 0 || layer >= map->layer_count || map->layers[layer].gids == NULL) {
+        return;
+    }
+    const adventure_bake_layer_t* baked = map->layers[layer].baked;
+    if (tx < 0 || ty < 0 || tx >= baked->width || ty >= baked->height || gid < 0 || gid > 0xFFFF) {
+        return;
+    }
+    adventure_tile_edited(map, layer, baked->data / sizeof(uint16_t) + ty * baked->width + tx);
+    adventure_tile_write(map, layer, tx, ty, gid);
+}
+
+// save the changing state of a map into snapshot, allocated in arena (reset the arena to drop it)
+bool adventure_snapshot_take(adventure_map_t* map, adventure_snapshot_t* snapshot, arena_t* arena) {
+    if (map == NULL || snapshot == NULL || arena == NULL) {
+        return false;
+    }
+    adventure_entities_t* entities = &map->entities;
+    int count = MAX(entities->count, 1);
+    memset(snapshot, 0, sizeof(adventure_snapshot_t));
+    snapshot->count = entities->count;
+    snapshot->x = arena_alloc(arena, sizeof(float) * count);
+    snapshot->y = arena_alloc(arena, sizeof(float) * count);
+    snapshot->gid = arena_alloc(arena, sizeof(int) * count);
+    snapshot->visible = arena_alloc(arena, sizeof(bool) * count);
+    snapshot->random = arena_alloc(arena, sizeof(adventure_random_t) * count);
+    snapshot->speed = arena_alloc(arena, sizeof(float) * count);
+    snapshot->awareness = arena_alloc(arena, sizeof(int) * count);
+    snapshot->edits = arena_alloc(arena, sizeof(adventure_tile_edit_t) * MAX(map->edit_count, 1));
+    if (snapshot->awareness == NULL || snapshot->edits == NULL) {
+        return false;
+    }
+    if (entities->count > 0) {
+        memcpy(snapshot->x, entities->x, sizeof(float) * entities->count);
+        memcpy(snapshot->y, entities->y, sizeof(float) * entities->count);
+        memcpy(snapshot->gid, entities->gid, sizeof(int) * entities->count);
+        memcpy(snapshot->visible, entities->visible, sizeof(bool) * entities->count);
+        memcpy(snapshot->random, entities->random, sizeof(adventure_random_t) * entities->count);
+        memcpy(snapshot->speed, entities->speed, sizeof(float) * entities->count);
+        memcpy(snapshot->awareness, entities->awareness, sizeof(int) * entities->count);
+    }
+
+    uint16_t* tiles = (uint16_t*)(map->blob + map->header->tiledata_offset);
+    for (int i = 0; i < map->edit_count; i++) {
+        snapshot->edits[i] = map->edits[i];
+        snapshot->edits[i].gid = tiles[map->edits[i].tile];
+    }
+    snapshot->edit_count = map->edit_count;
+    return true;
+}
+
+// put a map back how it was when snapshot was taken (it has to be a snapshot of this map)
+// costs what changed (plus a copy of the object-arrays), nothing is loaded or parsed
+bool adventure_snapshot_restore(adventure_map_t* map, adventure_snapshot_t* snapshot) {
+    if (map == NULL || snapshot == NULL || snapshot->count != map->entities.count) {
+        return false;
+    }
+    adventure_entities_t* entities = &map->entities;
+    if (entities->count > 0) {
+        memcpy(entities->x, snapshot->x, sizeof(float) * entities->count);
+        memcpy(entities->y, snapshot->y, sizeof(float) * entities->count);
+        memcpy(entities->prev_x, snapshot->x, sizeof(float) * entities->count);
+        memcpy(entities->prev_y, snapshot->y, sizeof(float) * entities->count);
+        memcpy(entities->gid, snapshot->gid, sizeof(int) * entities->count);
+        memcpy(entities->visible, snapshot->visible, sizeof(bool) * entities->count);
+        memcpy(entities->random, snapshot->random, sizeof(adventure_random_t) * entities->count);
+        memcpy(entities->speed, snapshot->speed, sizeof(float) * entities->count);
+        memcpy(entities->awareness, snapshot->awareness, sizeof(int) * entities->count);
+        for (int e = 0; e < entities->count; e++) {
+            adventure_grid_update(&map->grid, entities, e);
+        }
+    }
+    map->drawlist.count = 0;
+
+    // tiles changed since loading go back to how they were baked, then the snapshot's changes are made again
+    for (int i = 0; i < map->edit_count; i++) {
+        adventure_tile_edit_t* edit = &map->edits[i];
+        const adventure_bake_layer_t* baked = map->layers[edit->layer].baked;
+        uint32_t local = edit->tile - baked->data / sizeof(uint16_t);
+        adventure_tile_write(map, edit->layer, local % baked->width, local / baked->width, map->tiles_baked[edit->tile]);
+        map->tiles_edited[edit->tile >> 5] &= ~(1u << (edit->tile & 31));
+    }
+    map->edit_count = 0;
+    for (int i = 0; i < snapshot->edit_count; i++) {
+        adventure_tile_edit_t* edit = &snapshot->edits[i];
+        const adventure_bake_layer_t* baked = map->layers[edit->layer].baked;
+        uint32_t local = edit->tile - baked->data / sizeof(uint16_t);
+        adventure_set_tile(map, edit->layer, local % baked->width, local / baked->width, edit->gid);
+    }
+    return true;
+}
+
+// put a map back how it was when it loaded
+bool adventure_map_reset(adventure_map_t* map) {
+    return map != NULL && adventure_snapshot_restore(map, &map->initial);
+}
+
+// find the tileset a gid is in
+static adventure_tileset_t* adventure_tileset_for(adventure_map_t* map, int gid) {
+    adventure_tileset_t* tileset = NULL;
+    for (int i = 0; i < map->tileset_count; i++) {
+        if ((int)map->tilesets[i].baked->firstgid <= gid) {
+            tileset = &map->tilesets[i];
+        }
+    }
+    return tileset;
+}
+
+// is this gid an animated tile?
+static bool adventure_tile_animated(adventure_map_t* map, int gid) {
+    adventure_tileset_t* tileset = gid == 0 ? NULL : adventure_tileset_for(map, gid);
+    return tileset != NULL && adventure_anim_has(tileset->anim, gid - tileset->baked->firstgid);
+}
+
+// find which tileset (and which tile & source-rect in its image) to draw for a gid, following animations
+static adventure_tileset_t* adventure_tile_source(adventure_map_t* map, int gid, pntr_rectangle* src, uint32_t* drawn) {
+    adventure_tileset_t* tileset = adventure_tileset_for(map, gid);
+    if (tileset == NULL || tileset->image == NULL) {
+        return NULL;
+    }
+    const adventure_bake_tileset_t* baked = tileset->baked;
+    uint32_t tile = gid - baked->firstgid;
+    if (tile >= baked->tilecount || baked->columns == 0) {
+        return NULL;
+    }
+    tile = adventure_anim_tile(tileset->anim, tile);
+    *drawn = tile;
+    src->x = baked->margin + (tile % baked->columns) * (baked->tilewidth + baked->spacing);
+    src->y = baked->margin + (tile / baked->columns) * (baked->tileheight + baked->spacing);
+    src->width = baked->tilewidth;
+    src->height = baked->tileheight;
+    return tileset;
+}
+
+// draw a single tile, bottom-aligned in a map-tile (like Tiled does) at x/y
+void adventure_draw_tile(pntr_image* dst, adventure_map_t* map, int gid, int x, int y, pntr_color tint) {
+    pntr_rectangle src;
+    uint32_t tile;
+    adventure_tileset_t* tileset = adventure_tile_source(map, gid, &src, &tile);
+    if (tileset == NULL) {
+        return;
+    }
+    if (tileset->blit[tile] == ADVENTURE_BLIT_UNKNOWN) {
+        tileset->blit[tile] = adventure_blit_classify(tileset->image, src);
+    }
+    y += map->header->tileheight - src.height;
+    adventure_blit(dst, tileset->image, src, x, y, tileset->blit[tile], tint);
+}
+
+// find the run of tile-layers a layer is in (or NULL)
+static adventure_chunks_t* adventure_chunks_for(adventure_map_t* map, int layer) {
+    for (int r = 0; r < map->chunk_count; r++) {
+        if (layer >= map->chunks[r].first_layer && layer <= map->chunks[r].last_layer) {
+            return &map->chunks[r];
+        }
+    }
+    return NULL;
+}
+
+// does any layer in the run have an animated tile at tx/ty?
+static void adventure_chunks_dynamic(adventure_map_t* map, adventure_chunks_t* chunks, int tx, int ty) {
+    uint8_t dynamic = 0;
+    for (int l = chunks->first_layer; l <= chunks->last_layer && !dynamic; l++) {
+        adventure_layer_t* layer = &map->layers[l];
+        if (layer->visible && tx < layer->baked->width && ty < layer->baked->height) {
+            dynamic = adventure_tile_animated(map, layer->gids[ty * layer->baked->width + tx]);
+        }
+    }
+    chunks->dynamic[ty * map->header->width + tx] = dynamic;
+}
+
+// (re-)draw static tiles of a single chunk
+static void adventure_chunks_render(adventure_map_t* map, adventure_chunks_t* chunks, int c) {
+    int tw = MAX(map->header->tilewidth, 1);
+    int th = MAX(map->header->tileheight, 1);
+    int tx0 = (c % chunks->columns) * chunks->chunk_tiles_x;
+    int ty0 = (c / chunks->columns) * chunks->chunk_tiles_y;
+    int tx1 = MIN(tx0 + chunks->chunk_tiles_x, map->header->width);
+    int ty1 = MIN(ty0 + chunks->chunk_tiles_y, map->header->height);
 
-    if (maps->layer_collisions != NULL){
-        collision_static = adventure_check_static_collision(maps->map, maps->layer_collisions, &pos);
-        if (collision_static && callback != NULL) {
-            callback(app, maps, maps->player, NULL);
+    pntr_image* image = chunks->images[c];
+    if (image != NULL) {
+        pntr_clear_background(image, PNTR_BLANK);
+    }
+    bool any = false;
+
+    for (int l = chunks->first_layer; l <= chunks->last_layer; l++) {
+        adventure_layer_t* layer = &map->layers[l];
+        if (!layer->visible) {
+            continue;
+        }
+        pntr_color tint = layer->baked->opacity == 255 ? PNTR_WHITE : pntr_new_color(255, 255, 255, layer->baked->opacity);
+        for (int ty = ty0; ty < MIN(ty1, layer->baked->height); ty++) {
+            for (int tx = tx0; tx < MIN(tx1, layer->baked->width); tx++) {
+                int gid = layer->gids[ty * layer->baked->width + tx];
+                if (gid == 0 || chunks->dynamic[ty * map->header->width + tx]) {
+                    continue;
+                }
+                if (image == NULL) {
+                    image = pntr_gen_image_color(chunks->chunk_tiles_x * tw, chunks->chunk_tiles_y * th, PNTR_BLANK);
+                }
+                adventure_draw_tile(image, map, gid, (tx - tx0) * tw, (ty - ty0) * th, tint);
+                any = true;
+            }
         }
     }
 
-    if (maps->layer_objects != NULL){
-        cute_tiled_object_t* subject = adventure_check_object_collision(maps->layer_objects, &pos, maps->player);
-        if (subject != NULL) {
-            collision_objects = true;
-            if (callback != NULL) {
-                callback(app, maps, maps->player, subject);
+    if (!any && image != NULL) {
+        pntr_unload_image(image);
+        image = NULL;
+    }
+    chunks->images[c] = image;
+    chunks->blit[c] = image != NULL ? adventure_blit_classify(image, (pntr_rectangle) { 0, 0, image->width, image->height }) : ADVENTURE_BLIT_EMPTY;
+    chunks->dirty[c] = false;
+}
+
+// free a chunk's image, it's re-drawn if it's needed again (returns true if there was one)
+static bool adventure_chunks_free(adventure_chunks_t* chunks, int c) {
+    if (chunks->images[c] == NULL) {
+        return false;
+    }
+    pntr_unload_image(chunks->images[c]);
+    chunks->images[c] = NULL;
+    chunks->dirty[c] = true;
+    return true;
+}
+
+size_t adventure_map_bytes(adventure_map_t* map);
+
+// chunk-images were made or freed: tell the cache, so they count against its budget
+static void adventure_chunks_resized(adventure_map_t* map) {
+    if (map->cache != NULL) {
+        asset_cache_resize(map->cache, asset_cache_find(map->cache, map), adventure_map_bytes(map));
+    }
+}
+
+// split tile-layers into runs (broken up by object-layers), chunks are drawn when they are first on screen
+void adventure_chunks_build(adventure_map_t* map) {
+    const adventure_bake_header_t* header = map->header;
+    int tw = MAX(header->tilewidth, 1);
+    int th = MAX(header->tileheight, 1);
+
+    for (int pass = 0; pass < 2; pass++) {
+        int runs = 0;
+        for (int l = 0; l < map->layer_count; l++) {
+            if (map->layers[l].gids == NULL) {
+                continue;
+            }
+            if (l == 0 || map->layers[l - 1].gids == NULL) {
+                if (pass == 1) {
+                    map->chunks[runs].first_layer = l;
+                }
+                runs++;
+            }
+            if (pass == 1) {
+                map->chunks[runs - 1].last_layer = l;
+            }
+        }
+        if (pass == 0) {
+            map->chunk_count = runs;
+            map->chunks = arena_alloc(&map->arena, sizeof(adventure_chunks_t) * MAX(runs, 1));
+        }
+    }
+
+    for (int r = 0; r < map->chunk_count; r++) {
+        adventure_chunks_t* chunks = &map->chunks[r];
+        chunks->chunk_tiles_x = MAX(ADVENTURE_CHUNK_SIZE / tw, 1);
+        chunks->chunk_tiles_y = MAX(ADVENTURE_CHUNK_SIZE / th, 1);
+        chunks->columns = MAX((header->width + chunks->chunk_tiles_x - 1) / chunks->chunk_tiles_x, 1);
+        chunks->rows = MAX((header->height + chunks->chunk_tiles_y - 1) / chunks->chunk_tiles_y, 1);
+
+        int count = chunks->columns * chunks->rows;
+        chunks->images = arena_alloc(&map->arena, sizeof(pntr_image*) * count);
+        chunks->dirty = arena_alloc(&map->arena, sizeof(bool) * count);
+        chunks->blit = arena_alloc(&map->arena, count);
+        chunks->dynamic = arena_alloc(&map->arena, MAX(header->width * header->height, 1));
+
+        chunks->view_x0 = chunks->view_y0 = chunks->view_x1 = chunks->view_y1 = -1;
+
+        for (int ty = 0; ty < header->height; ty++) {
+            for (int tx = 0; tx < header->width; tx++) {
+                adventure_chunks_dynamic(map, chunks, tx, ty);
             }
         }
+        memset(chunks->dirty, 1, sizeof(bool) * count);
     }
+}
 
-    // if (!collision_static && !collision_objects) {
-    if (!collision_static) {
-        maps->player->x += req->x;
-        maps->player->y += req->y;
+// a tile changed, so the chunk it's in needs to be re-drawn
+void adventure_chunks_invalidate(adventure_map_t* map, int layer, int tx, int ty) {
+    adventure_chunks_t* chunks = adventure_chunks_for(map, layer);
+    if (chunks == NULL || tx < 0 || ty < 0 || tx >= map->header->width || ty >= map->header->height) {
+        return;
     }
+    adventure_chunks_dynamic(map, chunks, tx, ty);
+    chunks->dirty[(ty / chunks->chunk_tiles_y) * chunks->columns + (tx / chunks->chunk_tiles_x)] = true;
 }
 
-// load a single map into linked-list
-// if it's already loaded, return that
-adventure_map_t* adventure_load(char* filename, adventure_map_t** maps) {
-    // search for same name
-    adventure_map_t* found = (*maps);
-    while(found != NULL) {
-        if (PNTR_STRCMP(found->filename, filename) == 0) {
-            // pntr_app_log_ex(PNTR_APP_LOG_DEBUG, "Adventure: found '%s' (preloaded.)", filename);
-            break;
+// free every chunk-image of a map you are not drawing right now (they're re-drawn when it's drawn again)
+void adventure_chunks_trim(adventure_map_t* map) {
+    bool resized = false;
+    for (int r = 0; map != NULL && r < map->chunk_count; r++) {
+        adventure_chunks_t* chunks = &map->chunks[r];
+        for (int c = 0; c < chunks->columns * chunks->rows; c++) {
+            resized |= adventure_chunks_free(chunks, c);
+        }
+        chunks->view_x0 = chunks->view_y0 = chunks->view_x1 = chunks->view_y1 = -1;
+    }
+    if (resized) {
+        adventure_chunks_resized(map);
+    }
+}
+
+// free all chunk-images (the rest is in the map's arena)
+void adventure_chunks_unload(adventure_map_t* map) {
+    if (map->chunks == NULL) {
+        return;
+    }
+    for (int r = 0; r < map->chunk_count; r++) {
+        adventure_chunks_t* chunks = &map->chunks[r];
+        for (int c = 0; c < chunks->columns * chunks->rows; c++) {
+            if (chunks->images[c] != NULL) {
+                pntr_unload_image(chunks->images[c]);
+            }
+        }
+    }
+    map->chunks = NULL;
+    map->chunk_count = 0;
+}
+
+// draw a run of tile-layers: chunks that are on screen, then animated tiles over them
+static void adventure_chunks_draw(pntr_image* dst, adventure_map_t* map, adventure_chunks_t* chunks, int posX, int posY) {
+    int tw = MAX(map->header->tilewidth, 1);
+    int th = MAX(map->header->tileheight, 1);
+    int chunk_width = chunks->chunk_tiles_x * tw;
+    int chunk_height = chunks->chunk_tiles_y * th;
+
+    int cx0 = MAX(-posX / chunk_width, 0);
+    int cy0 = MAX(-posY / chunk_height, 0);
+    int cx1 = MIN((dst->width - posX - 1) / chunk_width, chunks->columns - 1);
+    int cy1 = MIN((dst->height - posY - 1) / chunk_height, chunks->rows - 1);
+    bool resized = false;
+
+    // the camera moved to other chunks: free the ones it left far behind
+    if (cx0 != chunks->view_x0 || cy0 != chunks->view_y0 || cx1 != chunks->view_x1 || cy1 != chunks->view_y1) {
+        for (int c = 0; c < chunks->columns * chunks->rows; c++) {
+            int cx = c % chunks->columns;
+            int cy = c / chunks->columns;
+            if (cx < cx0 - ADVENTURE_CHUNK_MARGIN || cx > cx1 + ADVENTURE_CHUNK_MARGIN || cy < cy0 - ADVENTURE_CHUNK_MARGIN || cy > cy1 + ADVENTURE_CHUNK_MARGIN) {
+                resized |= adventure_chunks_free(chunks, c);
+            }
+        }
+        chunks->view_x0 = cx0;
+        chunks->view_y0 = cy0;
+        chunks->view_x1 = cx1;
+        chunks->view_y1 = cy1;
+    }
+
+    for (int cy = cy0; cy <= cy1; cy++) {
+        for (int cx = cx0; cx <= cx1; cx++) {
+            int c = cy * chunks->columns + cx;
+            if (chunks->dirty[c]) {
+                pntr_image* image = chunks->images[c];
+                adventure_chunks_render(map, chunks, c);
+                resized |= chunks->images[c] != image;
+            }
+            if (chunks->images[c] != NULL) {
+                pntr_rectangle src = { 0, 0, chunks->images[c]->width, chunks->images[c]->height };
+                adventure_blit(dst, chunks->images[c], src, cx * chunk_width + posX, cy * chunk_height + posY, chunks->blit[c], PNTR_WHITE);
+            }
+        }
+    }
+    if (resized) {
+        adventure_chunks_resized(map);
+    }
+
+    int tx0 = MAX(-posX / tw, 0);
+    int ty0 = MAX(-posY / th, 0);
+    int tx1 = MIN((dst->width - posX) / tw, map->header->width - 1);
+    int ty1 = MIN((dst->height - posY) / th, map->header->height - 1);
+    for (int ty = ty0; ty <= ty1; ty++) {
+        for (int tx = tx0; tx <= tx1; tx++) {
+            if (!chunks->dynamic[ty * map->header->width + tx]) {
+                continue;
+            }
+            for (int l = chunks->first_layer; l <= chunks->last_layer; l++) {
+                adventure_layer_t* layer = &map->layers[l];
+                if (!layer->visible || tx >= layer->baked->width || ty >= layer->baked->height) {
+                    continue;
+                }
+                int gid = layer->gids[ty * layer->baked->width + tx];
+                if (gid != 0) {
+                    pntr_color tint = layer->baked->opacity == 255 ? PNTR_WHITE : pntr_new_color(255, 255, 255, layer->baked->opacity);
+                    adventure_draw_tile(dst, map, gid, tx * tw + posX, ty * th + posY, tint);
+                }
+            }
+        }
+    }
+}
+
+void adventure_drawlist_init(adventure_drawlist_t* drawlist, arena_t* arena, int count) {
+    memset(drawlist, 0, sizeof(adventure_drawlist_t));
+    drawlist->entities = arena_alloc(arena, sizeof(int) * MAX(count, 1));
+    drawlist->stamp = arena_alloc(arena, sizeof(uint32_t) * MAX(count, 1));
+}
+
+// is entity a drawn before entity b? (by bottom edge for ysort, otherwise in map-order)
+static inline bool adventure_drawlist_before(adventure_entities_t* entities, int a, int b, bool ysort) {
+    if (ysort) {
+        float ya = entities->y[a] + entities->height[a];
+        float yb = entities->y[b] + entities->height[b];
+        if (ya != yb) {
+            return ya < yb;
+        }
+    }
+    return a < b;
+}
+
+// find entities that are on screen (using the object-grid, so it costs what is on screen, not what is on the map)
+// and put them in draw-order. Whatever was on screen last frame keeps its place, so the sort has little to do
+void adventure_drawlist_build(adventure_drawlist_t* drawlist, adventure_map_t* map, int width, int height, int posX, int posY, bool ysort) {
+    adventure_entities_t* entities = &map->entities;
+    adventure_grid_t* grid = &map->grid;
+    if (drawlist->entities == NULL || grid->cells == NULL) {
+        drawlist->count = 0;
+        return;
+    }
+
+    // stamps are 2*frame(+1), start over before they wrap
+    if (++drawlist->frame >= 0x7FFFFFFF) {
+        memset(drawlist->stamp, 0, sizeof(uint32_t) * MAX(entities->count, 1));
+        drawlist->frame = 1;
+    }
+    uint32_t seen = drawlist->frame * 2;
+    uint32_t listed = seen + 1;
+
+    // sprites are bottom-aligned (& can be taller than their rect), so look 1 cell past the screen
+    adventure_grid_span_t span = {0};
+    adventure_grid_span(grid, -posX - grid->cell_width, -posY - grid->cell_height, width + grid->cell_width * 2, height + grid->cell_height * 2, &span);
+    for (int cy = span.y0; cy <= span.y1; cy++) {
+        for (int cx = span.x0; cx <= span.x1; cx++) {
+            adventure_grid_cell_t* cell = &grid->cells[cy * grid->width + cx];
+            for (int i = 0; i < cell->count; i++) {
+                int e = cell->entities[i];
+                if (entities->visible[e] && entities->gid[e] != 0) {
+                    drawlist->stamp[e] = seen;
+                }
+            }
+        }
+    }
+
+    // keep what is still on screen (in last frame's order)
+    int count = 0;
+    for (int i = 0; i < drawlist->count; i++) {
+        int e = drawlist->entities[i];
+        if (drawlist->stamp[e] == seen) {
+            drawlist->stamp[e] = listed;
+            drawlist->entities[count++] = e;
+        }
+    }
+
+    // add what just came on screen
+    for (int cy = span.y0; cy <= span.y1; cy++) {
+        for (int cx = span.x0; cx <= span.x1; cx++) {
+            adventure_grid_cell_t* cell = &grid->cells[cy * grid->width + cx];
+            for (int i = 0; i < cell->count; i++) {
+                int e = cell->entities[i];
+                if (drawlist->stamp[e] == seen) {
+                    drawlist->stamp[e] = listed;
+                    drawlist->entities[count++] = e;
+                }
+            }
+        }
+    }
+    drawlist->count = count;
+
+    // insertion-sort, nearly free when things are already in order
+    for (int i = 1; i < count; i++) {
+        int e = drawlist->entities[i];
+        int j = i - 1;
+        while (j >= 0 && adventure_drawlist_before(entities, e, drawlist->entities[j], ysort)) {
+            drawlist->entities[j + 1] = drawlist->entities[j];
+            j--;
         }
-        found = found->next;
+        drawlist->entities[j + 1] = e;
     }
+}
 
-    if (found != NULL) {
-        return found;
+// draw a map, offset by posX/posY (camera), only what is on screen
+void adventure_draw(pntr_image* dst, adventure_map_t* map, int posX, int posY) {
+    if (dst == NULL || map == NULL) {
+        return;
     }
-    // pntr_app_log_ex(PNTR_APP_LOG_DEBUG, "Adventure: loading '%s' (not preloaded.)", filename);
+    ADVENTURE_ZONE_BEGIN(DRAW);
+    const adventure_bake_header_t* header = map->header;
+    int th = MAX(header->tileheight, 1);
+
+    for (int l = 0; l < map->layer_count; l++) {
+        adventure_layer_t* layer = &map->layers[l];
+
+        // tile-layers are drawn a run at a time, from pre-drawn chunks
+        if (layer->gids != NULL) {
+            adventure_chunks_t* chunks = adventure_chunks_for(map, l);
+            if (chunks != NULL && chunks->first_layer == l) {
+                adventure_chunks_draw(dst, map, chunks, posX, posY);
+            }
+            continue;
+        }
+
+        if (!layer->visible) {
+            continue;
+        }
+        pntr_color tint = layer->baked->opacity == 255 ? PNTR_WHITE : pntr_new_color(255, 255, 255, layer->baked->opacity);
 
-    adventure_map_t* current = pntr_load_memory(sizeof(adventure_map_t));
-    current->map = pntr_load_tiled(filename);
-    current->filename = strdup(filename);
+        if (l == map->layer_objects) {
+            adventure_entities_t* entities = &map->entities;
+            adventure_drawlist_t* drawlist = &map->drawlist;
+            adventure_drawlist_build(drawlist, map, dst->width, dst->height, posX, posY, layer->ysort);
+            for (int i = 0; i < drawlist->count; i++) {
+                int e = drawlist->entities[i];
+                int x = (int)adventure_entity_lerp_x(entities, e, map->alpha);
+                int y = (int)(adventure_entity_lerp_y(entities, e, map->alpha) + entities->height[e]);
+                adventure_draw_tile(dst, map, entities->gid[e], x + posX, y - th + posY, tint);
+            }
+        }
 
-    cute_tiled_layer_t* layer = current->map->layers;
-    while(layer != NULL) {
-        if (PNTR_STRCMP("objects", layer->name.ptr) == 0) {
-            current->layer_objects = layer;
-            cute_tiled_object_t* obj = layer->objects;
-            while(obj != NULL) {
-                if (PNTR_STRCMP(obj->name.ptr, "player") == 0) {
-                    current->player = obj;
+        // other object-layers are not in the entity-store, so they are drawn as they were baked
+        else {
+            const adventure_bake_object_t* objects = ADVENTURE_BAKE_SECTION(header, const adventure_bake_object_t, header->object_offset) + layer->baked->first_object;
+            for (uint32_t i = 0; i < layer->baked->object_count; i++) {
+                if (objects[i].visible && objects[i].gid != 0) {
+                    adventure_draw_tile(dst, map, objects[i].gid, (int)objects[i].x + posX, (int)(objects[i].y + objects[i].height) - th + posY, tint);
                 }
-                obj  = obj->next;
             }
         }
-        else if (PNTR_STRCMP("collisions", layer->name.ptr) == 0) {
+    }
+    ADVENTURE_ZONE_END(DRAW);
+}
+
+// is the baked map newer than the map it was baked from? (or there is no source)
+// on web (and windows) assets don't change, so the baked one is always used
+static bool adventure_blob_fresh(const char* baked, const char* source) {
+#ifdef ADVENTURE_MMAP
+    struct stat baked_stat;
+    struct stat source_stat;
+    if (stat(baked, &baked_stat) != 0) {
+        return false;
+    }
+    return stat(source, &source_stat) != 0 || baked_stat.st_mtime >= source_stat.st_mtime;
+#else
+    return true;
+#endif
+}
+
+// is the baked map newer than the external tilesets (.tsj) it was baked from? (the ones that are still there)
+static bool adventure_blob_tilesets_fresh(const char* baked, const char* source, const adventure_bake_header_t* header) {
+#ifdef ADVENTURE_MMAP
+    struct stat baked_stat;
+    if (stat(baked, &baked_stat) != 0) {
+        return false;
+    }
+    char dir[PNTR_PATH_MAX];
+    adventure_bake_dirname(source, dir, sizeof(dir));
+    const adventure_bake_tileset_t* tilesets = ADVENTURE_BAKE_SECTION(header, const adventure_bake_tileset_t, header->tileset_offset);
+    for (uint32_t i = 0; i < header->tileset_count; i++) {
+        const char* tileset = adventure_bake_string(header, tilesets[i].source);
+        if (tileset == NULL) {
+            continue;
+        }
+        char path[PNTR_PATH_MAX];
+        snprintf(path, sizeof(path), "%s%s", dir, tileset);
+        struct stat tileset_stat;
+        if (stat(path, &tileset_stat) == 0 && tileset_stat.st_mtime > baked_stat.st_mtime) {
+            return false;
+        }
+    }
+#endif
+    return true;
+}
+
+// map a baked file into memory (copy-on-write, so tiles can be changed), or read it if there is no mmap
+static unsigned char* adventure_blob_load(const char* filename, size_t* size, bool* mapped) {
+    *mapped = false;
+#ifdef ADVENTURE_MMAP
+    int fd = open(filename, O_RDONLY);
+    if (fd < 0) {
+        return NULL;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size <= 0) {
+        close(fd);
+        return NULL;
+    }
+    void* data = mmap(NULL, (size_t)st.st_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED) {
+        return NULL;
+    }
+    *size = (size_t)st.st_size;
+    *mapped = true;
+    return data;
+#else
+    unsigned int bytes = 0;
+    unsigned char* data = pntr_load_file(filename, &bytes);
+    *size = bytes;
+    return data;
+#endif
+}
+
+static void adventure_blob_unload(unsigned char* blob, size_t size, bool mapped) {
+    if (blob == NULL) {
+        return;
+    }
+#ifdef ADVENTURE_MMAP
+    if (mapped) {
+        munmap(blob, size);
+        return;
+    }
+#endif
+    pntr_unload_memory(blob);
+}
+
+// about how much a map will allocate when it loads (so its arena can start with 1 block that fits it all)
+static size_t adventure_map_arena_size(const adventure_bake_header_t* header, const char* filename) {
+    size_t tiles = (size_t)MAX(header->width, 1) * MAX(header->height, 1);
+    size_t objects = header->object_count;
+    size_t bytes = sizeof(adventure_map_t) + PNTR_STRLEN(filename) + 1;
+    bytes += (sizeof(adventure_layer_t) + sizeof(adventure_chunks_t)) * header->layer_count;
+    bytes += (sizeof(adventure_tileset_t) + ARENA_ALIGN * 2) * header->tileset_count;
+    const adventure_bake_tileset_t* tilesets = ADVENTURE_BAKE_SECTION(header, const adventure_bake_tileset_t, header->tileset_offset);
+    for (uint32_t i = 0; i < header->tileset_count; i++) {
+        bytes += tilesets[i].tilecount;
+    }
+
+    // entities (& their grid-spans, draw-list, initial snapshot & a couple of cells each), grid-cells, collision-bits, flow-field & 1 run of chunks
+    bytes += objects * (sizeof(int) * 5 + sizeof(float) * 7 + sizeof(adventure_random_t) + sizeof(bool) + 1 + sizeof(adventure_type_t) + sizeof(adventure_props_t) + sizeof(adventure_grid_span_t) + sizeof(uint32_t));
+    bytes += objects * (sizeof(float) * 3 + sizeof(int) * 2 + sizeof(bool) + sizeof(adventure_random_t));
+    bytes += tiles * (sizeof(adventure_grid_cell_t) + sizeof(uint16_t) + sizeof(uint32_t) + sizeof(int) + 1) + tiles / 8;
+    return bytes + ARENA_ALIGN * 32;
+}
+
+// set up runtime state for a baked map (takes the blob)
+static adventure_map_t* adventure_map_from_blob(const char* filename, unsigned char* blob, size_t size, bool mapped) {
+    // the map lives in its own arena, so copy the arena into it before anything else is allocated
+    arena_t arena;
+    arena_init(&arena, 0);
+    arena_reserve(&arena, adventure_map_arena_size((const adventure_bake_header_t*)blob, filename));
+    adventure_map_t* current = arena_alloc(&arena, sizeof(adventure_map_t));
+    current->arena = arena;
+    current->blob = blob;
+    current->blob_size = size;
+    current->blob_mapped = mapped;
+    current->header = (const adventure_bake_header_t*)blob;
+    current->filename = arena_strdup(&current->arena, filename);
+    current->layer_objects = -1;
+    current->layer_collisions = -1;
+    current->alpha = 1.0f;
+
+    const adventure_bake_header_t* header = current->header;
+    const adventure_bake_anim_t* anims = ADVENTURE_BAKE_SECTION(header, const adventure_bake_anim_t, header->anim_offset);
+    const adventure_bake_frame_t* frames = ADVENTURE_BAKE_SECTION(header, const adventure_bake_frame_t, header->frame_offset);
+
+    // tileset images are relative to the map
+    char dir[PNTR_PATH_MAX];
+    adventure_bake_dirname(filename, dir, sizeof(dir));
+    const adventure_bake_tileset_t* tilesets = ADVENTURE_BAKE_SECTION(header, const adventure_bake_tileset_t, header->tileset_offset);
+    current->tileset_count = header->tileset_count;
+    current->tilesets = arena_alloc(&current->arena, sizeof(adventure_tileset_t) * MAX(current->tileset_count, 1));
+    for (int i = 0; i < current->tileset_count; i++) {
+        adventure_tileset_t* tileset = &current->tilesets[i];
+        tileset->baked = &tilesets[i];
+
+        char image[PNTR_PATH_MAX];
+        snprintf(image, sizeof(image), "%s%s", dir, adventure_bake_string(header, tilesets[i].image));
+        tileset->image = pntr_load_image(image);
+        if (tileset->image == NULL) {
+            pntr_app_log_ex(PNTR_APP_LOG_WARNING, "Adventure: could not load tileset-image '%s'", image);
+        }
+
+        tileset->anim = adventure_anim_acquire(image, &tilesets[i], anims, frames);
+        tileset->blit = arena_alloc(&current->arena, MAX(tilesets[i].tilecount, 1));
+    }
+
+    const adventure_bake_layer_t* layers = ADVENTURE_BAKE_SECTION(header, const adventure_bake_layer_t, header->layer_offset);
+    current->layer_count = header->layer_count;
+    current->layers = arena_alloc(&current->arena, sizeof(adventure_layer_t) * MAX(current->layer_count, 1));
+    for (int i = 0; i < current->layer_count; i++) {
+        adventure_layer_t* layer = &current->layers[i];
+        layer->baked = &layers[i];
+        layer->name = adventure_bake_string(header, layers[i].name);
+        layer->visible = layers[i].visible;
+        const char* class_ = adventure_bake_string(header, layers[i].class_);
+        layer->ysort = class_ != NULL && PNTR_STRCMP(class_, "ysort") == 0;
+        if (!layers[i].objects) {
+            layer->gids = (uint16_t*)(blob + header->tiledata_offset + layers[i].data);
+        }
+        if (layer->name == NULL) {
+            continue;
+        }
+        if (current->layer_objects == -1 && layers[i].objects && PNTR_STRCMP("objects", layer->name) == 0) {
+            current->layer_objects = i;
+        }
+        else if (current->layer_collisions == -1 && !layers[i].objects && PNTR_STRCMP("collisions", layer->name) == 0) {
             layer->visible = false;
-            current->layer_collisions = layer;
+            current->layer_collisions = i;
+            adventure_collision_build(&current->collision, &current->arena, header, layer);
+            adventure_nav_init(&current->nav, &current->arena, &current->collision);
         }
-        layer = layer->next;
     }
 
-    LL_PUSH(*maps, current);
+    // all per-frame object state lives in the entity-store, copied once here
+    if (current->layer_objects != -1) {
+        const adventure_bake_layer_t* objects = current->layers[current->layer_objects].baked;
+        adventure_entities_build(&current->entities, &current->arena, header, objects->first_object, objects->object_count);
+        adventure_entities_seed(&current->entities, adventure_random_hash(filename) + ADVENTURE_RANDOM_SEED);
+        adventure_grid_build(&current->grid, &current->arena, header, &current->entities);
+    } else {
+        adventure_entities_build(&current->entities, &current->arena, NULL, 0, 0);
+    }
+
+    adventure_chunks_build(current);
+    adventure_drawlist_init(&current->drawlist, &current->arena, current->entities.count);
+    adventure_snapshot_take(current, &current->initial, &current->arena);
+
     return current;
 }
 
-// free the current head of the list
-void adventure_unload(adventure_map_t** map) {
-    if (map && *map) {
-        adventure_map_t* to_free = *map;
-        cute_tiled_free_map((*map)->map);
-        *map = (*map)->next;
-        free(to_free);
+// load a single map (not cached, you probably want adventure_load)
+// uses the baked .lopb next to it if there is an up-to-date one, otherwise bakes it in memory
+adventure_map_t* adventure_map_load(const char* filename) {
+    ADVENTURE_ZONE_BEGIN(LOAD);
+    char baked[PNTR_PATH_MAX];
+    adventure_bake_path(filename, baked, sizeof(baked));
+
+    size_t size = 0;
+    bool mapped = false;
+    unsigned char* blob = NULL;
+    if (adventure_blob_fresh(baked, filename)) {
+        blob = adventure_blob_load(baked, &size, &mapped);
+        if (blob != NULL && !adventure_bake_valid(blob, size)) {
+            pntr_app_log_ex(PNTR_APP_LOG_WARNING, "Adventure: '%s' is not a valid baked map (version %d), baking '%s'", baked, ADVENTURE_BAKE_VERSION, filename);
+            adventure_blob_unload(blob, size, mapped);
+            blob = NULL;
+        }
+        else if (blob != NULL && !adventure_blob_tilesets_fresh(baked, filename, (const adventure_bake_header_t*)blob)) {
+            pntr_app_log_ex(PNTR_APP_LOG_INFO, "Adventure: a tileset changed since '%s' was baked, baking '%s'", baked, filename);
+            adventure_blob_unload(blob, size, mapped);
+            blob = NULL;
+        }
+    }
+    if (blob == NULL) {
+        mapped = false;
+        blob = adventure_bake_tiled(filename, &size);
+    }
+    if (blob == NULL || !adventure_bake_valid(blob, size)) {
+        pntr_app_log_ex(PNTR_APP_LOG_WARNING, "Adventure: could not load '%s'", filename);
+        adventure_blob_unload(blob, size, mapped);
+        ADVENTURE_ZONE_END(LOAD);
+        return NULL;
+    }
+    adventure_map_t* map = adventure_map_from_blob(filename, blob, size, mapped);
+    ADVENTURE_ZONE_END(LOAD);
+    return map;
+}
+
+// free a single map: images & blob, then everything else (map included) in 1 go
+void adventure_map_unload(adventure_map_t* map) {
+    if (map == NULL) {
+        return;
+    }
+    adventure_chunks_unload(map);
+    for (int i = 0; i < map->tileset_count; i++) {
+        if (map->tilesets[i].image != NULL) {
+            pntr_unload_image(map->tilesets[i].image);
+        }
+        adventure_anim_release(map->tilesets[i].anim);
+    }
+    adventure_blob_unload(map->blob, map->blob_size, map->blob_mapped);
+
+    // map is in its own arena, so that has to be copied out first
+    arena_t arena = map->arena;
+    arena_unload(&arena);
+}
+
+// rough memory-use of a map (for cache budget)
+// chunk-images come & go with the camera (only a few near it), so only the ones that are drawn right now count
+// (the cache is told again each time they change, see adventure_chunks_resized)
+size_t adventure_map_bytes(adventure_map_t* map) {
+    if (map == NULL) {
+        return 0;
+    }
+    size_t bytes = map->arena.bytes + map->blob_size;
+    for (int i = 0; i < map->tileset_count; i++) {
+        if (map->tilesets[i].image != NULL) {
+            bytes += sizeof(pntr_color) * map->tilesets[i].image->width * map->tilesets[i].image->height;
+        }
     }
+    for (int r = 0; r < map->chunk_count; r++) {
+        adventure_chunks_t* chunks = &map->chunks[r];
+        for (int c = 0; c < chunks->columns * chunks->rows; c++) {
+            if (chunks->images[c] != NULL) {
+                bytes += sizeof(pntr_color) * chunks->images[c]->width * chunks->images[c]->height;
+            }
+        }
+    }
+    return bytes;
+}
+
+// AssetLoadFn for asset_cache_t of maps, userdata is the cache (so chunk-images can be counted as they come & go)
+void* adventure_cache_load(const char* filename, void* userdata, size_t* bytes) {
+    adventure_map_t* map = adventure_map_load(filename);
+    if (map != NULL) {
+        map->cache = (asset_cache_t*)userdata;
+    }
+    *bytes = adventure_map_bytes(map);
+    return map;
+}
+
+// AssetUnloadFn for asset_cache_t of maps
+void adventure_cache_unload(void* map, void* userdata) {
+    adventure_map_unload((adventure_map_t*)map);
+}
+
+// set up a cache for maps, budget is in bytes (0 for unlimited)
+void adventure_cache_init(asset_cache_t* maps, size_t budget) {
+    asset_cache_init(maps, 16, budget, adventure_cache_load, adventure_cache_unload, maps);
+}
+
+// load a single map into cache
+// if it's already loaded, return that
+adventure_map_t* adventure_load(const char* filename, asset_cache_t* maps) {
+    return asset_cache_load(maps, filename);
+}
+
+// get a map by handle (from asset_cache_intern), loading it if needed
+adventure_map_t* adventure_get(asset_handle_t handle, asset_cache_t* maps) {
+    return asset_cache_get(maps, handle);
 }
 
-// set the current camera, based on screen/map size & lookAt position
-void adventure_camera_look_at(pntr_vector* camera, pntr_image* screen, cute_tiled_map_t* map, cute_tiled_object_t* lookAt) {
-    if (screen == NULL || map == NULL || lookAt == NULL ||  camera == NULL) {
+// set the current camera, based on screen/map size & lookAt entity
+void adventure_camera_look_at(pntr_vector* camera, pntr_image* screen, adventure_map_t* maps, int lookAt) {
+    if (screen == NULL || maps == NULL || lookAt < 0 || lookAt >= maps->entities.count ||  camera == NULL) {
         return;
     }
-    camera->x = MAX(0, lookAt->x - screen->width / 2);
-    camera->y = MAX(0, lookAt->y - screen->height / 2);
+    const adventure_bake_header_t* map = maps->header;
+    camera->x = MAX(0, adventure_entity_lerp_x(&maps->entities, lookAt, maps->alpha) - screen->width / 2);
+    camera->y = MAX(0, adventure_entity_lerp_y(&maps->entities, lookAt, maps->alpha) - screen->height / 2);
     camera->x = -1 * MIN(camera->x, (map->width * map->tilewidth) - screen->width);
     camera->y = -1 * MIN(camera->y , (map->height * map->tileheight) - screen->height);
 }
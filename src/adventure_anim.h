@@ -0,0 +1,217 @@
+// tile-animations: each tileset's animations are compiled (once, when the first map that uses it loads) into flat frame-tables
+// a table is shared by every loaded map that uses the same tileset, & frames come from 1 global clock (in ms),
+// so animating costs the same no matter how big (or how many) maps are, & only tiles that get drawn are looked up
+// tables are immutable once built, so drawing reads them without a lock (acquire/release lock, maps load on other threads)
+
+#if !defined(__EMSCRIPTEN__) && !defined(_WIN32)
+#define ADVENTURE_ANIM_THREADED
+#include <pthread.h>
+#endif
+
+// most slots in an animation's table, longer ones get longer slots (off by less than 1 slot, at most)
+#ifndef ADVENTURE_ANIM_MAX_SLOTS
+#define ADVENTURE_ANIM_MAX_SLOTS 1024
+#endif
+
+// a single animation: which frame to show is slots[(clock / step) % slot_count]
+typedef struct adventure_anim_t {
+    uint32_t step;          // ms per slot (gcd of frame-durations)
+    uint32_t slot_count;
+    uint32_t first_slot;
+} adventure_anim_t;
+
+typedef struct adventure_anim_table_t {
+    struct adventure_anim_table_t* next;
+    char* image;            // key: tileset-image (with the map's directory)
+    uint32_t hash;          // & what its animations are
+    int refs;
+
+    uint32_t tilecount;
+    int16_t* index;         // per local tile-index: index into anims, or -1
+    adventure_anim_t* anims;
+    uint16_t* slots;        // local tile-index to draw, per slot
+
+    arena_t arena;          // everything above (table included)
+} adventure_anim_table_t;
+
+// the clock every animation runs on, in ms (wraps after ~49 days)
+uint32_t adventure_anim_clock = 0;
+static float adventure_anim_remainder = 0;
+
+static adventure_anim_table_t* adventure_anim_tables = NULL;
+#ifdef ADVENTURE_ANIM_THREADED
+static pthread_mutex_t adventure_anim_lock = PTHREAD_MUTEX_INITIALIZER;
+#endif
+
+// advance the clock, once per frame (not per map)
+void adventure_anim_update(float dt) {
+    ADVENTURE_ZONE_BEGIN(ANIMATE);
+    adventure_anim_remainder += dt * 1000.0f;
+    uint32_t ms = (uint32_t)adventure_anim_remainder;
+    adventure_anim_clock += ms;
+    adventure_anim_remainder -= ms;
+    ADVENTURE_ZONE_END(ANIMATE);
+}
+
+static uint32_t adventure_anim_gcd(uint32_t a, uint32_t b) {
+    while (b != 0) {
+        uint32_t t = a % b;
+        a = b;
+        b = t;
+    }
+    return a;
+}
+
+// FNV-1a of a tileset's animations, so 2 tilesets with the same image but different animations don't share
+static uint32_t adventure_anim_hash(const adventure_bake_tileset_t* tileset, const adventure_bake_anim_t* anims, const adventure_bake_frame_t* frames) {
+    uint32_t hash = 2166136261u;
+    #define ADVENTURE_ANIM_HASH(value) hash = (hash ^ (uint32_t)(value)) * 16777619u
+    ADVENTURE_ANIM_HASH(tileset->tilecount);
+    for (uint32_t a = 0; a < tileset->anim_count; a++) {
+        const adventure_bake_anim_t* anim = &anims[tileset->first_anim + a];
+        ADVENTURE_ANIM_HASH(anim->tile);
+        for (uint32_t f = 0; f < anim->frame_count; f++) {
+            ADVENTURE_ANIM_HASH(frames[anim->first_frame + f].tile);
+            ADVENTURE_ANIM_HASH(frames[anim->first_frame + f].duration);
+        }
+    }
+    #undef ADVENTURE_ANIM_HASH
+    return hash;
+}
+
+// ms per slot of an animation (0 if it has no frames)
+static uint32_t adventure_anim_step(const adventure_bake_anim_t* anim, const adventure_bake_frame_t* frames) {
+    uint32_t step = 0;
+    for (uint32_t f = 0; f < anim->frame_count; f++) {
+        step = adventure_anim_gcd(step, frames[anim->first_frame + f].duration);
+    }
+    if (step == 0) {
+        return 0;
+    }
+    return MAX(step, (anim->duration + ADVENTURE_ANIM_MAX_SLOTS - 1) / ADVENTURE_ANIM_MAX_SLOTS);
+}
+
+static adventure_anim_table_t* adventure_anim_build(const char* image, uint32_t hash, const adventure_bake_tileset_t* tileset, const adventure_bake_anim_t* anims, const adventure_bake_frame_t* frames) {
+    // count slots first, so it all fits in 1 block
+    uint32_t slot_total = 0;
+    for (uint32_t a = 0; a < tileset->anim_count; a++) {
+        const adventure_bake_anim_t* anim = &anims[tileset->first_anim + a];
+        uint32_t step = adventure_anim_step(anim, frames);
+        if (step > 0) {
+            slot_total += (anim->duration + step - 1) / step;
+        }
+    }
+
+    arena_t arena;
+    arena_init(&arena, 0);
+    size_t size = sizeof(adventure_anim_table_t) + PNTR_STRLEN(image) + 1
+        + sizeof(int16_t) * tileset->tilecount
+        + sizeof(adventure_anim_t) * MAX(tileset->anim_count, 1)
+        + sizeof(uint16_t) * MAX(slot_total, 1)
+        + ARENA_ALIGN * 5;
+    if (!arena_reserve(&arena, size)) {
+        return NULL;
+    }
+    adventure_anim_table_t* table = arena_alloc(&arena, sizeof(adventure_anim_table_t));
+    table->image = arena_strdup(&arena, image);
+    table->hash = hash;
+    table->tilecount = tileset->tilecount;
+    table->index = arena_alloc(&arena, sizeof(int16_t) * tileset->tilecount);
+    memset(table->index, 0xFF, sizeof(int16_t) * tileset->tilecount);
+    table->anims = arena_alloc(&arena, sizeof(adventure_anim_t) * MAX(tileset->anim_count, 1));
+    table->slots = arena_alloc(&arena, sizeof(uint16_t) * MAX(slot_total, 1));
+
+    uint32_t slot = 0;
+    for (uint32_t a = 0; a < tileset->anim_count; a++) {
+        const adventure_bake_anim_t* anim = &anims[tileset->first_anim + a];
+        adventure_anim_t* out = &table->anims[a];
+        out->step = adventure_anim_step(anim, frames);
+        if (out->step == 0 || anim->tile >= tileset->tilecount) {
+            continue;
+        }
+        out->slot_count = (anim->duration + out->step - 1) / out->step;
+        out->first_slot = slot;
+
+        // each slot shows the frame that is up at its start
+        uint32_t f = 0;
+        uint32_t frame_end = frames[anim->first_frame].duration;
+        for (uint32_t s = 0; s < out->slot_count; s++) {
+            while (s * out->step >= frame_end && f + 1 < anim->frame_count) {
+                frame_end += frames[anim->first_frame + ++f].duration;
+            }
+            table->slots[slot++] = (uint16_t)frames[anim->first_frame + f].tile;
+        }
+        table->index[anim->tile] = (int16_t)a;
+    }
+
+    table->arena = arena;
+    return table;
+}
+
+// get the (shared) table for a tileset, building it if no loaded map uses it yet
+// image is the tileset-image with the map's directory, so the same tileset in different maps is found
+adventure_anim_table_t* adventure_anim_acquire(const char* image, const adventure_bake_tileset_t* tileset, const adventure_bake_anim_t* anims, const adventure_bake_frame_t* frames) {
+    if (image == NULL || tileset == NULL || tileset->anim_count == 0 || tileset->tilecount == 0) {
+        return NULL;
+    }
+    uint32_t hash = adventure_anim_hash(tileset, anims, frames);
+#ifdef ADVENTURE_ANIM_THREADED
+    pthread_mutex_lock(&adventure_anim_lock);
+#endif
+    adventure_anim_table_t* table = adventure_anim_tables;
+    while (table != NULL && (table->hash != hash || PNTR_STRCMP(table->image, image) != 0)) {
+        table = table->next;
+    }
+    if (table == NULL) {
+        table = adventure_anim_build(image, hash, tileset, anims, frames);
+        if (table != NULL) {
+            table->next = adventure_anim_tables;
+            adventure_anim_tables = table;
+        }
+    }
+    if (table != NULL) {
+        table->refs++;
+    }
+#ifdef ADVENTURE_ANIM_THREADED
+    pthread_mutex_unlock(&adventure_anim_lock);
+#endif
+    return table;
+}
+
+// let go of a table, it's freed when no map uses it
+void adventure_anim_release(adventure_anim_table_t* table) {
+    if (table == NULL) {
+        return;
+    }
+#ifdef ADVENTURE_ANIM_THREADED
+    pthread_mutex_lock(&adventure_anim_lock);
+#endif
+    if (--table->refs == 0) {
+        adventure_anim_table_t** link = &adventure_anim_tables;
+        while (*link != table) {
+            link = &(*link)->next;
+        }
+        *link = table->next;
+
+        // table is in its own arena, so that has to be copied out first
+        arena_t arena = table->arena;
+        arena_unload(&arena);
+    }
+#ifdef ADVENTURE_ANIM_THREADED
+    pthread_mutex_unlock(&adventure_anim_lock);
+#endif
+}
+
+// is this local tile-index animated?
+static inline bool adventure_anim_has(const adventure_anim_table_t* table, uint32_t tile) {
+    return table != NULL && tile < table->tilecount && table->index[tile] != -1;
+}
+
+// the local tile-index to draw for a tile right now (itself, if it's not animated)
+static inline uint32_t adventure_anim_tile(const adventure_anim_table_t* table, uint32_t tile) {
+    if (!adventure_anim_has(table, tile)) {
+        return tile;
+    }
+    const adventure_anim_t* anim = &table->anims[table->index[tile]];
+    return table->slots[anim->first_slot + (adventure_anim_clock / anim->step) % anim->slot_count];
+}
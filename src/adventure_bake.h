@@ -0,0 +1,594 @@
+// baked map format (.lopb)
+// a Tiled map (and its tilesets) flattened into one versioned blob, so it can be mmap'd & used in place:
+// tile layers are 16-bit gids, objects are pre-resolved (type, behaviour & game-properties), tileset animations are tables.
+// the same code bakes offline (tools/bake.c) and at runtime, when there is no .lopb next to the .tmj
+//
+// this only depends on pntr & cute_tiled, so the bake-tool can use it without pntr_app
+//
+// layout (all little-endian, every section 4-byte aligned):
+//   header | layers | tilesets | anims | frames | objects | properties | tile-data | strings
+// records point at each other with indexes, and at tile-data/strings with offsets into their section
+
+#define ADVENTURE_BAKE_MAGIC 0x42504F4Cu // "LOPB"
+#define ADVENTURE_BAKE_VERSION 2
+
+// tiled stores flip-flags in the high bits of gids, we don't use them
+#define ADVENTURE_GID_MASK 0x1FFFFFFFu
+
+// where bake errors go (adventure.h sends them to pntr_app's log)
+#ifndef ADVENTURE_BAKE_ERROR
+#define ADVENTURE_BAKE_ERROR(...) fprintf(stderr, __VA_ARGS__)
+#endif
+
+// what an object does every frame (can be combined)
+typedef enum adventure_behaviour_t {
+    ADVENTURE_BEHAVIOUR_NONE   = 0,
+    ADVENTURE_BEHAVIOUR_FOLLOW = 1 << 0, // bool property "follow"
+    ADVENTURE_BEHAVIOUR_AVOID  = 1 << 1  // bool property "avoid"
+} adventure_behaviour_t;
+
+// object "type" (class in Tiled)
+typedef enum adventure_type_t {
+    ADVENTURE_TYPE_NONE = 0,
+    ADVENTURE_TYPE_PORTAL,
+    ADVENTURE_TYPE_LOOT,
+    ADVENTURE_TYPE_CHEST,
+    ADVENTURE_TYPE_TRAP,
+    ADVENTURE_TYPE_ENEMY,
+    ADVENTURE_TYPE_SIGN,
+    ADVENTURE_TYPE_MUSING,
+    ADVENTURE_TYPE_OTHER   // has a type, but not one we know
+} adventure_type_t;
+
+// offset of a 0-terminated string in the strings-section, 0 means none
+typedef uint32_t adventure_bake_string_t;
+
+typedef struct adventure_bake_header_t {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t size;              // whole blob, in bytes
+    int32_t width;              // in tiles
+    int32_t height;
+    int32_t tilewidth;
+    int32_t tileheight;
+    uint32_t backgroundcolor;   // as Tiled stores it (0 for none)
+
+    uint32_t layer_count, layer_offset;
+    uint32_t tileset_count, tileset_offset;
+    uint32_t anim_count, anim_offset;
+    uint32_t frame_count, frame_offset;
+    uint32_t object_count, object_offset;
+    uint32_t property_count, property_offset;
+    uint32_t tiledata_size, tiledata_offset;
+    uint32_t string_size, string_offset;
+} adventure_bake_header_t;
+
+typedef struct adventure_bake_layer_t {
+    adventure_bake_string_t name;
+    adventure_bake_string_t class_;
+    uint8_t objects;            // 1 for object-layer, 0 for tile-layer
+    uint8_t visible;
+    uint8_t opacity;            // 0-255
+    uint8_t _pad;
+    int32_t width;
+    int32_t height;
+    uint32_t data;              // offset of width*height uint16 gids in tile-data (tile-layers)
+    uint32_t first_object;      // object-layers
+    uint32_t object_count;
+} adventure_bake_layer_t;
+
+typedef struct adventure_bake_tileset_t {
+    uint32_t firstgid;
+    uint32_t tilecount;
+    uint32_t columns;
+    uint32_t tilewidth;
+    uint32_t tileheight;
+    uint32_t margin;
+    uint32_t spacing;
+    adventure_bake_string_t image; // relative to the map's directory
+    adventure_bake_string_t source; // external tileset (.tsj) it was baked from, relative to the map's directory (0 if it's in the map)
+    uint32_t first_anim;
+    uint32_t anim_count;
+} adventure_bake_tileset_t;
+
+typedef struct adventure_bake_anim_t {
+    uint32_t tile;              // local tile-index in tileset
+    uint32_t first_frame;
+    uint32_t frame_count;
+    uint32_t duration;          // all frames, in ms
+} adventure_bake_anim_t;
+
+typedef struct adventure_bake_frame_t {
+    uint32_t tile;              // local tile-index in tileset
+    uint32_t duration;          // in ms
+} adventure_bake_frame_t;
+
+typedef struct adventure_bake_object_t {
+    int32_t id;
+    int32_t gid;
+    float x;                    // world-space top-left (tile-objects are converted from Tiled's bottom-left)
+    float y;
+    float width;
+    float height;
+    adventure_bake_string_t name;
+    adventure_bake_string_t type;
+
+    // pre-resolved
+    adventure_bake_string_t text;
+    adventure_bake_string_t speaker;
+    adventure_bake_string_t sound;
+    adventure_bake_string_t facing;
+    int32_t value;
+    int32_t pos_x;
+    int32_t pos_y;
+    uint8_t visible;
+    uint8_t behaviour;          // adventure_behaviour_t
+    uint8_t kind;               // adventure_type_t
+    uint8_t setpos;
+
+    // everything, for game-specific properties
+    uint32_t first_property;
+    uint32_t property_count;
+} adventure_bake_object_t;
+
+typedef struct adventure_bake_property_t {
+    adventure_bake_string_t name;
+    uint32_t type;              // CUTE_TILED_PROPERTY_TYPE
+    union {
+        int32_t integer;        // int & bool
+        float floating;
+        uint32_t color;
+        adventure_bake_string_t string; // string & file
+    } data;
+} adventure_bake_property_t;
+
+// get type-enum from type-string
+adventure_type_t adventure_type_from_string(const char* type) {
+    if (type == NULL || type[0] == 0) return ADVENTURE_TYPE_NONE;
+    if (PNTR_STRCMP(type, "portal") == 0) return ADVENTURE_TYPE_PORTAL;
+    if (PNTR_STRCMP(type, "loot") == 0) return ADVENTURE_TYPE_LOOT;
+    if (PNTR_STRCMP(type, "chest") == 0) return ADVENTURE_TYPE_CHEST;
+    if (PNTR_STRCMP(type, "trap") == 0) return ADVENTURE_TYPE_TRAP;
+    if (PNTR_STRCMP(type, "enemy") == 0) return ADVENTURE_TYPE_ENEMY;
+    if (PNTR_STRCMP(type, "sign") == 0) return ADVENTURE_TYPE_SIGN;
+    if (PNTR_STRCMP(type, "musing") == 0) return ADVENTURE_TYPE_MUSING;
+    return ADVENTURE_TYPE_OTHER;
+}
+
+
+// reading
+
+// get a string from a blob (NULL for none)
+static inline const char* adventure_bake_string(const adventure_bake_header_t* header, adventure_bake_string_t s) {
+    return s == 0 ? NULL : (const char*)header + header->string_offset + s;
+}
+
+#define ADVENTURE_BAKE_SECTION(header, type, offset) ((type*)((unsigned char*)(header) + (offset)))
+
+// check that a blob looks right, before using it
+// the blob is used in place, so every record's offsets & counts are checked against the sections they point into
+bool adventure_bake_valid(const void* blob, size_t size) {
+    const adventure_bake_header_t* header = (const adventure_bake_header_t*)blob;
+    if (blob == NULL || size < sizeof(adventure_bake_header_t) || header->magic != ADVENTURE_BAKE_MAGIC || header->version != ADVENTURE_BAKE_VERSION || header->size > size) {
+        return false;
+    }
+    if (header->width < 0 || header->height < 0 || header->tilewidth < 0 || header->tileheight < 0) {
+        return false;
+    }
+
+    // sections fit in the blob, & records are aligned (they are used in place)
+    #define ADVENTURE_BAKE_FITS(count, offset, type) ((offset) % 4 == 0 && (uint64_t)(offset) + (uint64_t)(count) * sizeof(type) <= header->size)
+    bool fits = ADVENTURE_BAKE_FITS(header->layer_count, header->layer_offset, adventure_bake_layer_t)
+        && ADVENTURE_BAKE_FITS(header->tileset_count, header->tileset_offset, adventure_bake_tileset_t)
+        && ADVENTURE_BAKE_FITS(header->anim_count, header->anim_offset, adventure_bake_anim_t)
+        && ADVENTURE_BAKE_FITS(header->frame_count, header->frame_offset, adventure_bake_frame_t)
+        && ADVENTURE_BAKE_FITS(header->object_count, header->object_offset, adventure_bake_object_t)
+        && ADVENTURE_BAKE_FITS(header->property_count, header->property_offset, adventure_bake_property_t)
+        && ADVENTURE_BAKE_FITS(header->tiledata_size, header->tiledata_offset, uint8_t)
+        && ADVENTURE_BAKE_FITS(header->string_size, header->string_offset, char);
+    #undef ADVENTURE_BAKE_FITS
+    if (!fits) {
+        return false;
+    }
+
+    // strings are 0-terminated, so any offset in the section ends in it
+    const char* strings = ADVENTURE_BAKE_SECTION(header, const char, header->string_offset);
+    if (header->string_size > 0 && strings[header->string_size - 1] != 0) {
+        return false;
+    }
+    #define ADVENTURE_BAKE_STRING_OK(s) ((s) == 0 || (s) < header->string_size)
+    // a range of records [first, first + count) is in a section of total records
+    #define ADVENTURE_BAKE_RANGE_OK(first, count, total) ((uint64_t)(first) + (uint64_t)(count) <= (uint64_t)(total))
+
+    const adventure_bake_layer_t* layers = ADVENTURE_BAKE_SECTION(header, const adventure_bake_layer_t, header->layer_offset);
+    for (uint32_t i = 0; i < header->layer_count; i++) {
+        const adventure_bake_layer_t* layer = &layers[i];
+        if (!ADVENTURE_BAKE_STRING_OK(layer->name) || !ADVENTURE_BAKE_STRING_OK(layer->class_)) {
+            return false;
+        }
+        if (layer->objects) {
+            if (!ADVENTURE_BAKE_RANGE_OK(layer->first_object, layer->object_count, header->object_count)) {
+                return false;
+            }
+        } else if (layer->width < 0 || layer->height < 0 || layer->data % sizeof(uint16_t) != 0
+            || (uint64_t)layer->data + (uint64_t)layer->width * (uint64_t)layer->height * sizeof(uint16_t) > header->tiledata_size) {
+            return false;
+        }
+    }
+
+    const adventure_bake_tileset_t* tilesets = ADVENTURE_BAKE_SECTION(header, const adventure_bake_tileset_t, header->tileset_offset);
+    const adventure_bake_anim_t* anims = ADVENTURE_BAKE_SECTION(header, const adventure_bake_anim_t, header->anim_offset);
+    const adventure_bake_frame_t* frames = ADVENTURE_BAKE_SECTION(header, const adventure_bake_frame_t, header->frame_offset);
+    for (uint32_t i = 0; i < header->tileset_count; i++) {
+        const adventure_bake_tileset_t* tileset = &tilesets[i];
+        if (!ADVENTURE_BAKE_STRING_OK(tileset->image) || !ADVENTURE_BAKE_STRING_OK(tileset->source) || !ADVENTURE_BAKE_RANGE_OK(tileset->first_anim, tileset->anim_count, header->anim_count)) {
+            return false;
+        }
+        for (uint32_t a = 0; a < tileset->anim_count; a++) {
+            const adventure_bake_anim_t* anim = &anims[tileset->first_anim + a];
+            if (anim->tile >= tileset->tilecount || !ADVENTURE_BAKE_RANGE_OK(anim->first_frame, anim->frame_count, header->frame_count)) {
+                return false;
+            }
+            for (uint32_t f = 0; f < anim->frame_count; f++) {
+                if (frames[anim->first_frame + f].tile >= tileset->tilecount) {
+                    return false;
+                }
+            }
+        }
+    }
+
+    const adventure_bake_object_t* objects = ADVENTURE_BAKE_SECTION(header, const adventure_bake_object_t, header->object_offset);
+    for (uint32_t i = 0; i < header->object_count; i++) {
+        const adventure_bake_object_t* object = &objects[i];
+        if (!ADVENTURE_BAKE_STRING_OK(object->name) || !ADVENTURE_BAKE_STRING_OK(object->type)
+            || !ADVENTURE_BAKE_STRING_OK(object->text) || !ADVENTURE_BAKE_STRING_OK(object->speaker)
+            || !ADVENTURE_BAKE_STRING_OK(object->sound) || !ADVENTURE_BAKE_STRING_OK(object->facing)
+            || !ADVENTURE_BAKE_RANGE_OK(object->first_property, object->property_count, header->property_count)) {
+            return false;
+        }
+    }
+
+    const adventure_bake_property_t* properties = ADVENTURE_BAKE_SECTION(header, const adventure_bake_property_t, header->property_offset);
+    for (uint32_t i = 0; i < header->property_count; i++) {
+        const adventure_bake_property_t* property = &properties[i];
+        bool string = property->type == CUTE_TILED_PROPERTY_STRING || property->type == CUTE_TILED_PROPERTY_FILE;
+        if (!ADVENTURE_BAKE_STRING_OK(property->name) || (string && !ADVENTURE_BAKE_STRING_OK(property->data.string))) {
+            return false;
+        }
+    }
+    #undef ADVENTURE_BAKE_STRING_OK
+    #undef ADVENTURE_BAKE_RANGE_OK
+    return true;
+}
+
+
+// writing
+
+// growable byte-buffer
+typedef struct adventure_bake_buffer_t {
+    unsigned char* data;
+    size_t size;
+    size_t capacity;
+} adventure_bake_buffer_t;
+
+// append bytes (pass NULL to append zeros), returns offset they were put at
+static size_t adventure_bake_append(adventure_bake_buffer_t* buffer, const void* data, size_t size) {
+    if (buffer->size + size > buffer->capacity) {
+        size_t capacity = buffer->capacity ? buffer->capacity : 256;
+        while (capacity < buffer->size + size) {
+            capacity *= 2;
+        }
+        unsigned char* grown = pntr_load_memory(capacity);
+        if (buffer->data != NULL) {
+            memcpy(grown, buffer->data, buffer->size);
+            pntr_unload_memory(buffer->data);
+        }
+        buffer->data = grown;
+        buffer->capacity = capacity;
+    }
+    size_t offset = buffer->size;
+    if (data != NULL) {
+        memcpy(buffer->data + offset, data, size);
+    } else {
+        memset(buffer->data + offset, 0, size);
+    }
+    buffer->size += size;
+    return offset;
+}
+
+// pad to 4 bytes
+static void adventure_bake_align(adventure_bake_buffer_t* buffer) {
+    while (buffer->size % 4) {
+        adventure_bake_append(buffer, NULL, 1);
+    }
+}
+
+static void adventure_bake_buffer_free(adventure_bake_buffer_t* buffer) {
+    if (buffer->data != NULL) {
+        pntr_unload_memory(buffer->data);
+    }
+    memset(buffer, 0, sizeof(adventure_bake_buffer_t));
+}
+
+// everything being built
+typedef struct adventure_bake_t {
+    adventure_bake_buffer_t layers;
+    adventure_bake_buffer_t tilesets;
+    adventure_bake_buffer_t anims;
+    adventure_bake_buffer_t frames;
+    adventure_bake_buffer_t objects;
+    adventure_bake_buffer_t properties;
+    adventure_bake_buffer_t tiledata;
+    adventure_bake_buffer_t strings;
+} adventure_bake_t;
+
+static adventure_bake_string_t adventure_bake_add_string(adventure_bake_t* bake, const char* s) {
+    if (s == NULL) {
+        return 0;
+    }
+    if (bake->strings.size == 0) {
+        // offset 0 is "none"
+        adventure_bake_append(&bake->strings, NULL, 1);
+    }
+    return (adventure_bake_string_t)adventure_bake_append(&bake->strings, s, PNTR_STRLEN(s) + 1);
+}
+
+// directory part of a path (with trailing slash), or "" if there is none
+static void adventure_bake_dirname(const char* path, char* out, size_t size) {
+    const char* slash = strrchr(path, '/');
+    size_t len = slash ? (size_t)(slash - path + 1) : 0;
+    if (len >= size) {
+        len = size - 1;
+    }
+    memcpy(out, path, len);
+    out[len] = 0;
+}
+
+static void adventure_bake_add_tileset(adventure_bake_t* bake, cute_tiled_tileset_t* tileset, int firstgid, const char* dir, const char* source) {
+    adventure_bake_tileset_t out = {0};
+    out.firstgid = firstgid;
+    out.tilecount = tileset->tilecount;
+    out.columns = tileset->columns;
+    out.tilewidth = tileset->tilewidth;
+    out.tileheight = tileset->tileheight;
+    out.margin = tileset->margin;
+    out.spacing = tileset->spacing;
+
+    char image[PNTR_PATH_MAX];
+    snprintf(image, sizeof(image), "%s%s", dir, tileset->image.ptr ? tileset->image.ptr : "");
+    out.image = adventure_bake_add_string(bake, image);
+    out.source = adventure_bake_add_string(bake, source);
+
+    out.first_anim = bake->anims.size / sizeof(adventure_bake_anim_t);
+    for (cute_tiled_tile_descriptor_t* tile = tileset->tiles; tile != NULL; tile = tile->next) {
+        if (tile->frame_count <= 0 || tile->animation == NULL) {
+            continue;
+        }
+        adventure_bake_anim_t anim = {0};
+        anim.tile = tile->tile_index;
+        anim.first_frame = bake->frames.size / sizeof(adventure_bake_frame_t);
+        anim.frame_count = tile->frame_count;
+        for (int i = 0; i < tile->frame_count; i++) {
+            adventure_bake_frame_t frame = { tile->animation[i].tileid, tile->animation[i].duration };
+            anim.duration += frame.duration;
+            adventure_bake_append(&bake->frames, &frame, sizeof(frame));
+        }
+        adventure_bake_append(&bake->anims, &anim, sizeof(anim));
+        out.anim_count++;
+    }
+    adventure_bake_append(&bake->tilesets, &out, sizeof(out));
+}
+
+static void adventure_bake_add_object(adventure_bake_t* bake, cute_tiled_object_t* obj) {
+    adventure_bake_object_t out = {0};
+    out.id = obj->id;
+    out.gid = (int32_t)((uint32_t)obj->gid & ADVENTURE_GID_MASK);
+    out.x = obj->x;
+    // Tiled positions tile-objects (anything with a gid) by their bottom-left corner
+    out.y = out.gid != 0 ? obj->y - obj->height : obj->y;
+    out.width = obj->width;
+    out.height = obj->height;
+    out.name = adventure_bake_add_string(bake, obj->name.ptr);
+    out.type = adventure_bake_add_string(bake, obj->type.ptr);
+    out.visible = obj->visible ? 1 : 0;
+    out.kind = adventure_type_from_string(obj->type.ptr);
+    out.value = 1;
+
+    out.first_property = bake->properties.size / sizeof(adventure_bake_property_t);
+    out.property_count = obj->property_count;
+    for (int i = 0; i < obj->property_count; i++) {
+        cute_tiled_property_t* prop = &obj->properties[i];
+        adventure_bake_property_t p = {0};
+        p.name = adventure_bake_add_string(bake, prop->name.ptr);
+        p.type = prop->type;
+
+        if (prop->type == CUTE_TILED_PROPERTY_STRING || prop->type == CUTE_TILED_PROPERTY_FILE) {
+            p.data.string = adventure_bake_add_string(bake, prop->data.string.ptr);
+            if (PNTR_STRCMP("text", prop->name.ptr) == 0) {
+                out.text = p.data.string;
+            }
+            else if (PNTR_STRCMP("name", prop->name.ptr) == 0) {
+                out.speaker = p.data.string;
+            }
+            else if (PNTR_STRCMP("sound", prop->name.ptr) == 0) {
+                out.sound = p.data.string;
+            }
+            else if (PNTR_STRCMP("facing", prop->name.ptr) == 0) {
+                out.facing = p.data.string;
+            }
+        }
+        else if (prop->type == CUTE_TILED_PROPERTY_INT) {
+            p.data.integer = prop->data.integer;
+            if (PNTR_STRCMP("pos_x", prop->name.ptr) == 0) {
+                out.pos_x = prop->data.integer;
+                out.setpos = 1;
+            }
+            else if (PNTR_STRCMP("pos_y", prop->name.ptr) == 0) {
+                out.pos_y = prop->data.integer;
+                out.setpos = 1;
+            }
+            else if (PNTR_STRCMP("value", prop->name.ptr) == 0) {
+                out.value = prop->data.integer;
+            }
+        }
+        else if (prop->type == CUTE_TILED_PROPERTY_BOOL) {
+            p.data.integer = prop->data.boolean;
+            if (prop->data.boolean && PNTR_STRCMP("follow", prop->name.ptr) == 0) {
+                out.behaviour |= ADVENTURE_BEHAVIOUR_FOLLOW;
+            }
+            else if (prop->data.boolean && PNTR_STRCMP("avoid", prop->name.ptr) == 0) {
+                out.behaviour |= ADVENTURE_BEHAVIOUR_AVOID;
+            }
+        }
+        else if (prop->type == CUTE_TILED_PROPERTY_FLOAT) {
+            p.data.floating = prop->data.floating;
+        }
+        else if (prop->type == CUTE_TILED_PROPERTY_COLOR) {
+            p.data.color = prop->data.color;
+        }
+        adventure_bake_append(&bake->properties, &p, sizeof(p));
+    }
+    adventure_bake_append(&bake->objects, &out, sizeof(out));
+}
+
+// returns false if the layer can't be baked (a gid that doesn't fit in 16 bits)
+static bool adventure_bake_add_layer(adventure_bake_t* bake, cute_tiled_layer_t* layer, const char* filename) {
+    adventure_bake_layer_t out = {0};
+    out.name = adventure_bake_add_string(bake, layer->name.ptr);
+    out.class_ = adventure_bake_add_string(bake, layer->class_.ptr);
+    out.visible = layer->visible ? 1 : 0;
+    float opacity = layer->opacity < 0 ? 0 : (layer->opacity > 1 ? 1 : layer->opacity);
+    out.opacity = (uint8_t)(opacity * 255.0f + 0.5f);
+
+    if (layer->objects != NULL || layer->data == NULL) {
+        out.objects = 1;
+        out.first_object = bake->objects.size / sizeof(adventure_bake_object_t);
+        for (cute_tiled_object_t* obj = layer->objects; obj != NULL; obj = obj->next) {
+            adventure_bake_add_object(bake, obj);
+            out.object_count++;
+        }
+    } else {
+        out.width = layer->width;
+        out.height = layer->height;
+        out.data = bake->tiledata.size;
+        for (int i = 0; i < layer->width * layer->height; i++) {
+            uint32_t gid = i < layer->data_count ? ((uint32_t)layer->data[i] & ADVENTURE_GID_MASK) : 0;
+            if (gid > 0xFFFF) {
+                ADVENTURE_BAKE_ERROR("%s: layer '%s' has gid %u at %d,%d, baked maps only fit gids up to 65535\n", filename, layer->name.ptr ? layer->name.ptr : "", (unsigned)gid, i % layer->width, i / layer->width);
+                return false;
+            }
+            uint16_t packed = (uint16_t)gid;
+            adventure_bake_append(&bake->tiledata, &packed, sizeof(packed));
+        }
+        adventure_bake_align(&bake->tiledata);
+    }
+    adventure_bake_append(&bake->layers, &out, sizeof(out));
+    return true;
+}
+
+static void adventure_bake_free(adventure_bake_t* bake) {
+    adventure_bake_buffer_free(&bake->layers);
+    adventure_bake_buffer_free(&bake->tilesets);
+    adventure_bake_buffer_free(&bake->anims);
+    adventure_bake_buffer_free(&bake->frames);
+    adventure_bake_buffer_free(&bake->objects);
+    adventure_bake_buffer_free(&bake->properties);
+    adventure_bake_buffer_free(&bake->tiledata);
+    adventure_bake_buffer_free(&bake->strings);
+}
+
+// bake a Tiled map (.tmj) into a blob, returns NULL on failure (a map that can't be baked is logged with ADVENTURE_BAKE_ERROR)
+// free the blob with pntr_unload_memory
+unsigned char* adventure_bake_tiled(const char* filename, size_t* size) {
+    cute_tiled_map_t* map = cute_tiled_load_map_from_file(filename, NULL);
+    if (map == NULL) {
+        return NULL;
+    }
+
+    char dir[PNTR_PATH_MAX];
+    adventure_bake_dirname(filename, dir, sizeof(dir));
+
+    adventure_bake_t bake;
+    memset(&bake, 0, sizeof(bake));
+
+    for (cute_tiled_tileset_t* tileset = map->tilesets; tileset != NULL; tileset = tileset->next) {
+        if (tileset->source.ptr != NULL && tileset->source.ptr[0] != 0) {
+            // external tileset: image is relative to the tileset
+            char path[PNTR_PATH_MAX];
+            snprintf(path, sizeof(path), "%s%s", dir, tileset->source.ptr);
+            cute_tiled_tileset_t* external = cute_tiled_load_external_tileset(path, NULL);
+            if (external == NULL) {
+                continue;
+            }
+            char tileset_dir[PNTR_PATH_MAX];
+            adventure_bake_dirname(tileset->source.ptr, tileset_dir, sizeof(tileset_dir));
+            adventure_bake_add_tileset(&bake, external, tileset->firstgid, tileset_dir, tileset->source.ptr);
+            cute_tiled_free_external_tileset(external);
+        } else {
+            adventure_bake_add_tileset(&bake, tileset, tileset->firstgid, "", NULL);
+        }
+    }
+
+    for (cute_tiled_layer_t* layer = map->layers; layer != NULL; layer = layer->next) {
+        if (!adventure_bake_add_layer(&bake, layer, filename)) {
+            cute_tiled_free_map(map);
+            adventure_bake_free(&bake);
+            return NULL;
+        }
+    }
+
+    adventure_bake_header_t header = {0};
+    header.magic = ADVENTURE_BAKE_MAGIC;
+    header.version = ADVENTURE_BAKE_VERSION;
+    header.width = map->width;
+    header.height = map->height;
+    header.tilewidth = map->tilewidth;
+    header.tileheight = map->tileheight;
+    header.backgroundcolor = map->backgroundcolor;
+    cute_tiled_free_map(map);
+
+    // lay out sections (all of them are already multiples of 4, except strings, which go last)
+    adventure_bake_buffer_t blob = {0};
+    adventure_bake_append(&blob, NULL, sizeof(header));
+    #define ADVENTURE_BAKE_SECTION_OUT(buffer, count_field, offset_field, record) \
+        header.offset_field = adventure_bake_append(&blob, bake.buffer.data, bake.buffer.size); \
+        header.count_field = bake.buffer.size / (record); \
+        adventure_bake_align(&blob);
+    ADVENTURE_BAKE_SECTION_OUT(layers, layer_count, layer_offset, sizeof(adventure_bake_layer_t))
+    ADVENTURE_BAKE_SECTION_OUT(tilesets, tileset_count, tileset_offset, sizeof(adventure_bake_tileset_t))
+    ADVENTURE_BAKE_SECTION_OUT(anims, anim_count, anim_offset, sizeof(adventure_bake_anim_t))
+    ADVENTURE_BAKE_SECTION_OUT(frames, frame_count, frame_offset, sizeof(adventure_bake_frame_t))
+    ADVENTURE_BAKE_SECTION_OUT(objects, object_count, object_offset, sizeof(adventure_bake_object_t))
+    ADVENTURE_BAKE_SECTION_OUT(properties, property_count, property_offset, sizeof(adventure_bake_property_t))
+    ADVENTURE_BAKE_SECTION_OUT(tiledata, tiledata_size, tiledata_offset, 1)
+    ADVENTURE_BAKE_SECTION_OUT(strings, string_size, string_offset, 1)
+    #undef ADVENTURE_BAKE_SECTION_OUT
+    header.size = blob.size;
+    memcpy(blob.data, &header, sizeof(header));
+
+    adventure_bake_free(&bake);
+
+    *size = blob.size;
+    return blob.data;
+}
+
+// the .lopb path for a map (same name, different extension)
+// if ADVENTURE_BAKE_DIR is defined (native builds bake into the build-dir), a relative map-path is looked up under that
+void adventure_bake_path(const char* filename, char* out, size_t size) {
+#ifdef ADVENTURE_BAKE_DIR
+    if (filename[0] != '/') {
+        snprintf(out, size, "%s/%s", ADVENTURE_BAKE_DIR, filename);
+    } else {
+        snprintf(out, size, "%s", filename);
+    }
+#else
+    snprintf(out, size, "%s", filename);
+#endif
+    char* dot = strrchr(out, '.');
+    char* slash = strrchr(out, '/');
+    if (dot != NULL && (slash == NULL || dot > slash)) {
+        *dot = 0;
+    }
+    size_t len = PNTR_STRLEN(out);
+    snprintf(out + len, size - len, ".lopb");
+}
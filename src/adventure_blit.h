@@ -0,0 +1,329 @@
+// fast paths for what the renderer blits most: tiles & chunk-images, mostly into the screen
+// a source-rect is classified once (adventure_blit_classify): OPAQUE is a memcpy per row, MASK (every pixel is fully
+// solid or fully clear) is a masked store, & ALPHA (or anything with a tint) is blended
+// rows are done with AVX2 or SSE2 on x86 (picked at runtime), SIMD128 on web (if built with -msimd128), or plain C
+// define ADVENTURE_BLIT_SCALAR to only build plain C
+// same result as pntr_draw_image_rec/pntr_draw_image_tint_rec, except blending into opaque pixels rounds a little differently (1-2 per channel)
+
+#ifndef ADVENTURE_BLIT_SCALAR
+#if defined(__x86_64__) || defined(_M_X64) || (defined(__i386__) && defined(__SSE2__))
+#define ADVENTURE_BLIT_SSE2
+#include <emmintrin.h>
+#if defined(__GNUC__) || defined(__clang__)
+#define ADVENTURE_BLIT_AVX2
+#include <immintrin.h>
+#endif
+#elif defined(__wasm_simd128__)
+#define ADVENTURE_BLIT_WASM
+#include <wasm_simd128.h>
+#endif
+#endif
+
+typedef enum adventure_blit_kind_t {
+    ADVENTURE_BLIT_UNKNOWN = 0, // not classified yet (drawn as ALPHA)
+    ADVENTURE_BLIT_EMPTY,       // every pixel is clear, nothing to draw
+    ADVENTURE_BLIT_OPAQUE,      // every pixel is solid
+    ADVENTURE_BLIT_MASK,        // every pixel is solid or clear
+    ADVENTURE_BLIT_ALPHA
+} adventure_blit_kind_t;
+
+// blend/mask count pixels of src into dst (tint is only used by blend)
+typedef void (*AdventureBlitRow)(pntr_color* dst, const pntr_color* src, int count, pntr_color tint);
+
+typedef struct adventure_blit_rows_t {
+    const char* name;
+    AdventureBlitRow mask;
+    AdventureBlitRow blend;
+} adventure_blit_rows_t;
+
+#define ADVENTURE_BLIT_ALPHA_MASK 0xFF000000u   // alpha is the top byte (in RGBA & ARGB pixel-formats)
+
+// work out what kind of blit a rect of an image needs
+adventure_blit_kind_t adventure_blit_classify(pntr_image* image, pntr_rectangle rect) {
+    if (image == NULL) {
+        return ADVENTURE_BLIT_EMPTY;
+    }
+    int x0 = rect.x < 0 ? 0 : rect.x;
+    int y0 = rect.y < 0 ? 0 : rect.y;
+    int x1 = rect.x + rect.width > image->width ? image->width : rect.x + rect.width;
+    int y1 = rect.y + rect.height > image->height ? image->height : rect.y + rect.height;
+    bool solid = false;
+    bool clear = false;
+    for (int y = y0; y < y1; y++) {
+        const pntr_color* row = (const pntr_color*)((const unsigned char*)image->data + (size_t)y * image->pitch);
+        for (int x = x0; x < x1; x++) {
+            uint32_t alpha = row[x].value & ADVENTURE_BLIT_ALPHA_MASK;
+            if (alpha == ADVENTURE_BLIT_ALPHA_MASK) {
+                solid = true;
+            } else if (alpha == 0) {
+                clear = true;
+            } else {
+                return ADVENTURE_BLIT_ALPHA;
+            }
+        }
+    }
+    if (!solid) {
+        return ADVENTURE_BLIT_EMPTY;
+    }
+    return clear ? ADVENTURE_BLIT_MASK : ADVENTURE_BLIT_OPAQUE;
+}
+
+static void adventure_blit_mask_scalar(pntr_color* dst, const pntr_color* src, int count, pntr_color tint) {
+    for (int i = 0; i < count; i++) {
+        if (src[i].value & ADVENTURE_BLIT_ALPHA_MASK) {
+            dst[i] = src[i];
+        }
+    }
+}
+
+// exactly what pntr does (& how the SIMD ones do pixels that are not opaque in dst)
+static void adventure_blit_blend_scalar(pntr_color* dst, const pntr_color* src, int count, pntr_color tint) {
+    bool white = tint.value == PNTR_WHITE.value;
+    for (int i = 0; i < count; i++) {
+        pntr_blend_color(&dst[i], white ? src[i] : pntr_color_tint(src[i], tint));
+    }
+}
+
+#ifdef ADVENTURE_BLIT_SSE2
+static void adventure_blit_mask_sse2(pntr_color* dst, const pntr_color* src, int count, pntr_color tint) {
+    const __m128i alpha = _mm_set1_epi32((int)ADVENTURE_BLIT_ALPHA_MASK);
+    const __m128i zero = _mm_setzero_si128();
+    int i = 0;
+    for (; i + 4 <= count; i += 4) {
+        __m128i s = _mm_loadu_si128((const __m128i*)(src + i));
+        __m128i d = _mm_loadu_si128((const __m128i*)(dst + i));
+        __m128i clear = _mm_cmpeq_epi32(_mm_and_si128(s, alpha), zero);
+        _mm_storeu_si128((__m128i*)(dst + i), _mm_or_si128(_mm_and_si128(clear, d), _mm_andnot_si128(clear, s)));
+    }
+    adventure_blit_mask_scalar(dst + i, src + i, count - i, tint);
+}
+
+// x / 255 (rounded), for x up to 255 * 255
+static inline __m128i adventure_blit_div255_sse2(__m128i x) {
+    x = _mm_add_epi16(x, _mm_set1_epi16(128));
+    return _mm_srli_epi16(_mm_add_epi16(x, _mm_srli_epi16(x, 8)), 8);
+}
+
+// 2 pixels, 16 bits per channel: tint src, then src * alpha + dst * (255 - alpha)
+static inline __m128i adventure_blit_blend2_sse2(__m128i s, __m128i d, __m128i t) {
+    s = adventure_blit_div255_sse2(_mm_mullo_epi16(s, t));
+    __m128i a = _mm_shufflehi_epi16(_mm_shufflelo_epi16(s, 0xFF), 0xFF);
+    __m128i ia = _mm_sub_epi16(_mm_set1_epi16(255), a);
+    return adventure_blit_div255_sse2(_mm_add_epi16(_mm_mullo_epi16(s, a), _mm_mullo_epi16(d, ia)));
+}
+
+static void adventure_blit_blend_sse2(pntr_color* dst, const pntr_color* src, int count, pntr_color tint) {
+    const __m128i alpha = _mm_set1_epi32((int)ADVENTURE_BLIT_ALPHA_MASK);
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i t = _mm_unpacklo_epi8(_mm_set1_epi32((int)tint.value), zero);
+    int i = 0;
+    for (; i + 4 <= count; i += 4) {
+        __m128i d = _mm_loadu_si128((const __m128i*)(dst + i));
+        // only opaque dst is done here (so the result is opaque), pntr's formula for the rest
+        if (_mm_movemask_epi8(_mm_cmpeq_epi32(_mm_and_si128(d, alpha), alpha)) != 0xFFFF) {
+            adventure_blit_blend_scalar(dst + i, src + i, 4, tint);
+            continue;
+        }
+        __m128i s = _mm_loadu_si128((const __m128i*)(src + i));
+        __m128i lo = adventure_blit_blend2_sse2(_mm_unpacklo_epi8(s, zero), _mm_unpacklo_epi8(d, zero), t);
+        __m128i hi = adventure_blit_blend2_sse2(_mm_unpackhi_epi8(s, zero), _mm_unpackhi_epi8(d, zero), t);
+        _mm_storeu_si128((__m128i*)(dst + i), _mm_or_si128(_mm_packus_epi16(lo, hi), alpha));
+    }
+    adventure_blit_blend_scalar(dst + i, src + i, count - i, tint);
+}
+#endif
+
+#ifdef ADVENTURE_BLIT_AVX2
+#define ADVENTURE_BLIT_AVX2_FN __attribute__((target("avx2")))
+
+ADVENTURE_BLIT_AVX2_FN static void adventure_blit_mask_avx2(pntr_color* dst, const pntr_color* src, int count, pntr_color tint) {
+    const __m256i alpha = _mm256_set1_epi32((int)ADVENTURE_BLIT_ALPHA_MASK);
+    int i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m256i s = _mm256_loadu_si256((const __m256i*)(src + i));
+        __m256i d = _mm256_loadu_si256((const __m256i*)(dst + i));
+        __m256i clear = _mm256_cmpeq_epi32(_mm256_and_si256(s, alpha), _mm256_setzero_si256());
+        _mm256_storeu_si256((__m256i*)(dst + i), _mm256_blendv_epi8(s, d, clear));
+    }
+    // the rest is SSE, so clear the upper halves first (or it stalls)
+    _mm256_zeroupper();
+    adventure_blit_mask_sse2(dst + i, src + i, count - i, tint);
+}
+
+ADVENTURE_BLIT_AVX2_FN static inline __m256i adventure_blit_div255_avx2(__m256i x) {
+    x = _mm256_add_epi16(x, _mm256_set1_epi16(128));
+    return _mm256_srli_epi16(_mm256_add_epi16(x, _mm256_srli_epi16(x, 8)), 8);
+}
+
+ADVENTURE_BLIT_AVX2_FN static inline __m256i adventure_blit_blend4_avx2(__m256i s, __m256i d, __m256i t) {
+    s = adventure_blit_div255_avx2(_mm256_mullo_epi16(s, t));
+    __m256i a = _mm256_shufflehi_epi16(_mm256_shufflelo_epi16(s, 0xFF), 0xFF);
+    __m256i ia = _mm256_sub_epi16(_mm256_set1_epi16(255), a);
+    return adventure_blit_div255_avx2(_mm256_add_epi16(_mm256_mullo_epi16(s, a), _mm256_mullo_epi16(d, ia)));
+}
+
+// unpack/pack work inside each 128-bit half, so pixels come back out in order
+ADVENTURE_BLIT_AVX2_FN static void adventure_blit_blend_avx2(pntr_color* dst, const pntr_color* src, int count, pntr_color tint) {
+    const __m256i alpha = _mm256_set1_epi32((int)ADVENTURE_BLIT_ALPHA_MASK);
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i t = _mm256_unpacklo_epi8(_mm256_set1_epi32((int)tint.value), zero);
+    int i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m256i d = _mm256_loadu_si256((const __m256i*)(dst + i));
+        if ((uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi32(_mm256_and_si256(d, alpha), alpha)) != 0xFFFFFFFFu) {
+            _mm256_zeroupper();
+            adventure_blit_blend_scalar(dst + i, src + i, 8, tint);
+            continue;
+        }
+        __m256i s = _mm256_loadu_si256((const __m256i*)(src + i));
+        __m256i lo = adventure_blit_blend4_avx2(_mm256_unpacklo_epi8(s, zero), _mm256_unpacklo_epi8(d, zero), t);
+        __m256i hi = adventure_blit_blend4_avx2(_mm256_unpackhi_epi8(s, zero), _mm256_unpackhi_epi8(d, zero), t);
+        _mm256_storeu_si256((__m256i*)(dst + i), _mm256_or_si256(_mm256_packus_epi16(lo, hi), alpha));
+    }
+    _mm256_zeroupper();
+    adventure_blit_blend_sse2(dst + i, src + i, count - i, tint);
+}
+#endif
+
+#ifdef ADVENTURE_BLIT_WASM
+static void adventure_blit_mask_wasm(pntr_color* dst, const pntr_color* src, int count, pntr_color tint) {
+    const v128_t alpha = wasm_i32x4_splat((int32_t)ADVENTURE_BLIT_ALPHA_MASK);
+    int i = 0;
+    for (; i + 4 <= count; i += 4) {
+        v128_t s = wasm_v128_load(src + i);
+        v128_t d = wasm_v128_load(dst + i);
+        v128_t solid = wasm_i32x4_ne(wasm_v128_and(s, alpha), wasm_i32x4_splat(0));
+        wasm_v128_store(dst + i, wasm_v128_bitselect(s, d, solid));
+    }
+    adventure_blit_mask_scalar(dst + i, src + i, count - i, tint);
+}
+
+static inline v128_t adventure_blit_div255_wasm(v128_t x) {
+    x = wasm_i16x8_add(x, wasm_i16x8_splat(128));
+    return wasm_u16x8_shr(wasm_i16x8_add(x, wasm_u16x8_shr(x, 8)), 8);
+}
+
+static inline v128_t adventure_blit_blend2_wasm(v128_t s, v128_t d, v128_t t) {
+    s = adventure_blit_div255_wasm(wasm_i16x8_mul(s, t));
+    v128_t a = wasm_i16x8_shuffle(s, s, 3, 3, 3, 3, 7, 7, 7, 7);
+    v128_t ia = wasm_i16x8_sub(wasm_i16x8_splat(255), a);
+    return adventure_blit_div255_wasm(wasm_i16x8_add(wasm_i16x8_mul(s, a), wasm_i16x8_mul(d, ia)));
+}
+
+static void adventure_blit_blend_wasm(pntr_color* dst, const pntr_color* src, int count, pntr_color tint) {
+    const v128_t alpha = wasm_i32x4_splat((int32_t)ADVENTURE_BLIT_ALPHA_MASK);
+    const v128_t t = wasm_u16x8_extend_low_u8x16(wasm_i32x4_splat((int32_t)tint.value));
+    int i = 0;
+    for (; i + 4 <= count; i += 4) {
+        v128_t d = wasm_v128_load(dst + i);
+        if (!wasm_i32x4_all_true(wasm_i32x4_eq(wasm_v128_and(d, alpha), alpha))) {
+            adventure_blit_blend_scalar(dst + i, src + i, 4, tint);
+            continue;
+        }
+        v128_t s = wasm_v128_load(src + i);
+        v128_t lo = adventure_blit_blend2_wasm(wasm_u16x8_extend_low_u8x16(s), wasm_u16x8_extend_low_u8x16(d), t);
+        v128_t hi = adventure_blit_blend2_wasm(wasm_u16x8_extend_high_u8x16(s), wasm_u16x8_extend_high_u8x16(d), t);
+        wasm_v128_store(dst + i, wasm_v128_or(wasm_u8x16_narrow_i16x8(lo, hi), alpha));
+    }
+    adventure_blit_blend_scalar(dst + i, src + i, count - i, tint);
+}
+#endif
+
+// every row-implementation in this build, best last
+static const adventure_blit_rows_t adventure_blit_all[] = {
+    { "scalar", adventure_blit_mask_scalar, adventure_blit_blend_scalar },
+#ifdef ADVENTURE_BLIT_SSE2
+    { "sse2", adventure_blit_mask_sse2, adventure_blit_blend_sse2 },
+#endif
+#ifdef ADVENTURE_BLIT_AVX2
+    { "avx2", adventure_blit_mask_avx2, adventure_blit_blend_avx2 },
+#endif
+#ifdef ADVENTURE_BLIT_WASM
+    { "simd128", adventure_blit_mask_wasm, adventure_blit_blend_wasm },
+#endif
+};
+
+#define ADVENTURE_BLIT_ALL_COUNT ((int)(sizeof(adventure_blit_all) / sizeof(adventure_blit_rows_t)))
+
+// picked the first time something is blitted (same answer on any thread)
+static const adventure_blit_rows_t* adventure_blit_rows = NULL;
+
+// can this CPU run an implementation?
+static bool adventure_blit_supported(const adventure_blit_rows_t* rows) {
+#ifdef ADVENTURE_BLIT_AVX2
+    if (rows->mask == adventure_blit_mask_avx2) {
+        __builtin_cpu_init();
+        return __builtin_cpu_supports("avx2");
+    }
+#endif
+    return true;
+}
+
+// use an implementation by name ("scalar", "sse2", "avx2", "simd128"), or NULL for the best this CPU can do
+// returns false (& changes nothing) if it's not in this build or the CPU can't run it
+bool adventure_blit_use(const char* name) {
+    for (int i = ADVENTURE_BLIT_ALL_COUNT - 1; i >= 0; i--) {
+        if ((name == NULL || PNTR_STRCMP(name, adventure_blit_all[i].name) == 0) && adventure_blit_supported(&adventure_blit_all[i])) {
+            adventure_blit_rows = &adventure_blit_all[i];
+            return true;
+        }
+    }
+    return false;
+}
+
+// name of the implementation in use
+const char* adventure_blit_name() {
+    if (adventure_blit_rows == NULL) {
+        adventure_blit_use(NULL);
+    }
+    return adventure_blit_rows->name;
+}
+
+// draw rect of src at x/y in dst (clipped to dst's clip-rect), kind is from adventure_blit_classify
+// any tint other than white is blended (like pntr_draw_image_tint_rec)
+void adventure_blit(pntr_image* dst, pntr_image* src, pntr_rectangle rect, int x, int y, adventure_blit_kind_t kind, pntr_color tint) {
+    if (dst == NULL || src == NULL || kind == ADVENTURE_BLIT_EMPTY || (tint.value & ADVENTURE_BLIT_ALPHA_MASK) == 0) {
+        return;
+    }
+    if (adventure_blit_rows == NULL) {
+        adventure_blit_use(NULL);
+    }
+
+    // clip to src, then dst
+    int left = rect.x < 0 ? -rect.x : 0;
+    int top = rect.y < 0 ? -rect.y : 0;
+    left = x + left < dst->clip.x ? dst->clip.x - x : left;
+    top = y + top < dst->clip.y ? dst->clip.y - y : top;
+    int right = rect.x + rect.width > src->width ? rect.x + rect.width - src->width : 0;
+    int bottom = rect.y + rect.height > src->height ? rect.y + rect.height - src->height : 0;
+    int overhang = x + rect.width - (dst->clip.x + dst->clip.width);
+    right = overhang > right ? overhang : right;
+    overhang = y + rect.height - (dst->clip.y + dst->clip.height);
+    bottom = overhang > bottom ? overhang : bottom;
+    rect.x += left;
+    rect.y += top;
+    rect.width -= left + right;
+    rect.height -= top + bottom;
+    x += left;
+    y += top;
+    if (rect.width <= 0 || rect.height <= 0) {
+        return;
+    }
+
+    if (tint.value != PNTR_WHITE.value || kind == ADVENTURE_BLIT_UNKNOWN) {
+        kind = ADVENTURE_BLIT_ALPHA;
+    }
+    unsigned char* out = (unsigned char*)dst->data + (size_t)y * dst->pitch + (size_t)x * sizeof(pntr_color);
+    const unsigned char* in = (const unsigned char*)src->data + (size_t)rect.y * src->pitch + (size_t)rect.x * sizeof(pntr_color);
+    for (int row = 0; row < rect.height; row++) {
+        if (kind == ADVENTURE_BLIT_OPAQUE) {
+            memcpy(out, in, sizeof(pntr_color) * rect.width);
+        } else if (kind == ADVENTURE_BLIT_MASK) {
+            adventure_blit_rows->mask((pntr_color*)out, (const pntr_color*)in, rect.width, tint);
+        } else {
+            adventure_blit_rows->blend((pntr_color*)out, (const pntr_color*)in, rect.width, tint);
+        }
+        out += dst->pitch;
+        in += src->pitch;
+    }
+}
@@ -0,0 +1,100 @@
+// contact-tracker: which objects something (the player) is touching, and what changed since the last tick
+// handlers are registered per object-type, and get ENTER (started touching), EXIT (stopped) & STAY (still touching, only if they ask for it)
+// so a chest, trap or enemy reacts once when you walk into it, instead of on every tick you stand on it
+
+#ifndef ADVENTURE_CONTACTS_MAX
+#define ADVENTURE_CONTACTS_MAX 32
+#endif
+
+#define ADVENTURE_TYPE_COUNT (ADVENTURE_TYPE_OTHER + 1)
+
+typedef enum adventure_contact_event_t {
+    ADVENTURE_CONTACT_ENTER = 1 << 0,
+    ADVENTURE_CONTACT_STAY = 1 << 1,
+    ADVENTURE_CONTACT_EXIT = 1 << 2
+} adventure_contact_event_t;
+
+// subject/object are entity-indexes in map->entities, props are object's (parsed when the map was baked)
+typedef void (*AdventureContactHandler)(pntr_app* app, adventure_map_t* map, int subject, int object, adventure_props_t* props, adventure_contact_event_t event);
+
+typedef struct adventure_contacts_t {
+    AdventureContactHandler handlers[ADVENTURE_TYPE_COUNT];
+    int events[ADVENTURE_TYPE_COUNT];       // which events each type's handler gets
+
+    adventure_map_t* map;                   // contacts are on this map, they are dropped if it changes
+    int subject;
+    int touching[ADVENTURE_CONTACTS_MAX];   // entity-indexes, in order
+    int count;
+    bool cleared;                           // set by adventure_contacts_clear, stops the events still to be sent
+} adventure_contacts_t;
+
+void adventure_contacts_init(adventure_contacts_t* contacts) {
+    memset(contacts, 0, sizeof(adventure_contacts_t));
+    contacts->subject = -1;
+}
+
+// set the handler for a type of object, events is which ones it wants (ADVENTURE_CONTACT_ENTER | ADVENTURE_CONTACT_EXIT, etc)
+void adventure_contacts_on(adventure_contacts_t* contacts, adventure_type_t type, AdventureContactHandler handler, int events) {
+    if (contacts == NULL || type < 0 || type >= ADVENTURE_TYPE_COUNT) {
+        return;
+    }
+    contacts->handlers[type] = handler;
+    contacts->events[type] = events;
+}
+
+// forget everything that is being touched, without EXIT events (like when the map changes)
+// if a handler calls this, the rest of that update's events are not sent
+void adventure_contacts_clear(adventure_contacts_t* contacts) {
+    contacts->map = NULL;
+    contacts->subject = -1;
+    contacts->count = 0;
+    contacts->cleared = true;
+}
+
+static void adventure_contacts_send(adventure_contacts_t* contacts, pntr_app* app, adventure_map_t* map, int subject, int object, adventure_contact_event_t event) {
+    adventure_type_t type = map->entities.type[object];
+    if (type >= 0 && type < ADVENTURE_TYPE_COUNT && contacts->handlers[type] != NULL && (contacts->events[type] & event)) {
+        contacts->handlers[type](app, map, subject, object, &map->entities.props[object], event);
+    }
+}
+
+// find what subject (or a hitbox in it, relative to its top-left) touches now, and send events for what changed
+// call once per simulation-tick, after things have moved
+void adventure_contacts_update(adventure_contacts_t* contacts, pntr_app* app, adventure_map_t* map, int subject, const pntr_rectangle* hitbox) {
+    if (contacts == NULL) {
+        return;
+    }
+    if (map != contacts->map || subject != contacts->subject) {
+        adventure_contacts_clear(contacts);
+    }
+    contacts->cleared = false;
+    if (map == NULL || subject < 0 || subject >= map->entities.count) {
+        return;
+    }
+    contacts->map = map;
+    contacts->subject = subject;
+
+    int before[ADVENTURE_CONTACTS_MAX];
+    int before_count = contacts->count;
+    memcpy(before, contacts->touching, sizeof(int) * before_count);
+
+    pntr_rectangle rect = adventure_entity_rect(&map->entities, subject, hitbox);
+    contacts->count = adventure_find_object_collisions(&map->grid, &map->entities, &rect, subject, contacts->touching, ADVENTURE_CONTACTS_MAX);
+
+    // both are in order, so walk them together: only in before is EXIT, only in now is ENTER, in both is STAY
+    int* now = contacts->touching;
+    int now_count = contacts->count;
+    int i = 0;
+    int j = 0;
+    while ((i < before_count || j < now_count) && !contacts->cleared) {
+        if (j == now_count || (i < before_count && before[i] < now[j])) {
+            adventure_contacts_send(contacts, app, map, subject, before[i++], ADVENTURE_CONTACT_EXIT);
+        } else if (i == before_count || now[j] < before[i]) {
+            adventure_contacts_send(contacts, app, map, subject, now[j++], ADVENTURE_CONTACT_ENTER);
+        } else {
+            adventure_contacts_send(contacts, app, map, subject, now[j], ADVENTURE_CONTACT_STAY);
+            i++;
+            j++;
+        }
+    }
+}
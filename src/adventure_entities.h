@@ -0,0 +1,141 @@
+// entity-store for the objects-layer of a map
+// everything the game needs per-frame is copied once (on map-load) from the baked objects into flat arrays, indexed by entity,
+// so the update-loop & collisions never have to walk properties or compare strings
+
+// properties that the game uses (resolved when the map was baked)
+// strings point into the map's blob, so they live as long as it does
+typedef struct adventure_props_t {
+    const char* name;    // object name (portals use this as target map)
+    const char* text;    // dialog text
+    const char* speaker; // "name" property, shown over dialog
+    const char* sound;   // name of rfx in assets/rfx/
+    const char* facing;
+    int value;           // defaults to 1
+    int pos_x;
+    int pos_y;
+    bool setpos;
+    uint32_t sound_handle;  // free for the game to resolve sound into (0 = not yet)
+    uint32_t target_handle; // free for the game to resolve a portal's target into (0 = not yet)
+} adventure_props_t;
+
+// struct-of-arrays for all objects on the objects-layer
+// x/y are world-space top-left (tile-objects are converted from Tiled's bottom-left on load)
+typedef struct adventure_entities_t {
+    int count;
+    int player; // index of object named "player", or -1
+
+    int* id;
+    float* x;
+    float* y;
+    float* prev_x;  // position at the start of the last simulation-tick (for render interpolation)
+    float* prev_y;
+    float* width;
+    float* height;
+    int* gid;
+    bool* visible;
+    unsigned char* behaviour;
+    adventure_type_t* type;
+    adventure_props_t* props;
+
+    // per-entity random stream, and NPC movement the game picks from it once (0 until it has)
+    adventure_random_t* random;
+    float* speed;       // pixels per second
+    int* awareness;     // radius in tiles
+} adventure_entities_t;
+
+// build entities from baked objects (see adventure_bake.h), arrays are in arena (the map's), so they go when it's reset
+void adventure_entities_build(adventure_entities_t* entities, arena_t* arena, const adventure_bake_header_t* header, uint32_t first, uint32_t count) {
+    if (entities == NULL) {
+        return;
+    }
+    memset(entities, 0, sizeof(adventure_entities_t));
+    entities->player = -1;
+    if (header == NULL || count == 0) {
+        return;
+    }
+
+    entities->count = (int)count;
+    entities->id = arena_alloc(arena, sizeof(int) * count);
+    entities->x = arena_alloc(arena, sizeof(float) * count);
+    entities->y = arena_alloc(arena, sizeof(float) * count);
+    entities->prev_x = arena_alloc(arena, sizeof(float) * count);
+    entities->prev_y = arena_alloc(arena, sizeof(float) * count);
+    entities->width = arena_alloc(arena, sizeof(float) * count);
+    entities->height = arena_alloc(arena, sizeof(float) * count);
+    entities->gid = arena_alloc(arena, sizeof(int) * count);
+    entities->visible = arena_alloc(arena, sizeof(bool) * count);
+    entities->behaviour = arena_alloc(arena, sizeof(unsigned char) * count);
+    entities->type = arena_alloc(arena, sizeof(adventure_type_t) * count);
+    entities->props = arena_alloc(arena, sizeof(adventure_props_t) * count);
+    entities->random = arena_alloc(arena, sizeof(adventure_random_t) * count);
+    entities->speed = arena_alloc(arena, sizeof(float) * count);
+    entities->awareness = arena_alloc(arena, sizeof(int) * count);
+
+    const adventure_bake_object_t* objects = ADVENTURE_BAKE_SECTION(header, const adventure_bake_object_t, header->object_offset) + first;
+    for (int i = 0; i < entities->count; i++) {
+        const adventure_bake_object_t* obj = &objects[i];
+        entities->id[i] = obj->id;
+        entities->x[i] = obj->x;
+        entities->y[i] = obj->y;
+        entities->prev_x[i] = obj->x;
+        entities->prev_y[i] = obj->y;
+        entities->width[i] = obj->width;
+        entities->height[i] = obj->height;
+        entities->gid[i] = obj->gid;
+        entities->visible[i] = obj->visible;
+        entities->behaviour[i] = obj->behaviour;
+        entities->type[i] = (adventure_type_t)obj->kind;
+
+        adventure_props_t* props = &entities->props[i];
+        props->name = adventure_bake_string(header, obj->name);
+        props->text = adventure_bake_string(header, obj->text);
+        props->speaker = adventure_bake_string(header, obj->speaker);
+        props->sound = adventure_bake_string(header, obj->sound);
+        props->facing = adventure_bake_string(header, obj->facing);
+        props->value = obj->value;
+        props->pos_x = obj->pos_x;
+        props->pos_y = obj->pos_y;
+        props->setpos = obj->setpos;
+
+        if (entities->player == -1 && props->name != NULL && PNTR_STRCMP(props->name, "player") == 0) {
+            entities->player = i;
+        }
+    }
+}
+
+// give every entity its own random stream, from a seed (for the map) & its object id
+// so the same object on the same map always rolls the same numbers
+void adventure_entities_seed(adventure_entities_t* entities, uint64_t seed) {
+    if (entities == NULL) {
+        return;
+    }
+    for (int i = 0; i < entities->count; i++) {
+        entities->random[i] = adventure_random_stream(seed, (uint64_t)entities->id[i]);
+    }
+}
+
+// remember where everything is, call at the start of each simulation-tick
+void adventure_entities_snapshot(adventure_entities_t* entities) {
+    if (entities == NULL || entities->count == 0) {
+        return;
+    }
+    memcpy(entities->prev_x, entities->x, sizeof(float) * entities->count);
+    memcpy(entities->prev_y, entities->y, sizeof(float) * entities->count);
+}
+
+// position between the last 2 ticks (alpha 0 is start of tick, 1 is now)
+static inline float adventure_entity_lerp_x(adventure_entities_t* entities, int e, float alpha) {
+    return entities->prev_x[e] + (entities->x[e] - entities->prev_x[e]) * alpha;
+}
+
+static inline float adventure_entity_lerp_y(adventure_entities_t* entities, int e, float alpha) {
+    return entities->prev_y[e] + (entities->y[e] - entities->prev_y[e]) * alpha;
+}
+
+// world-space rect of an entity, optionally just the hitbox inside it
+static pntr_rectangle adventure_entity_rect(adventure_entities_t* entities, int e, const pntr_rectangle* hitbox) {
+    if (hitbox == NULL) {
+        return (pntr_rectangle) { entities->x[e], entities->y[e], entities->width[e], entities->height[e] };
+    }
+    return (pntr_rectangle) { entities->x[e] + hitbox->x, entities->y[e] + hitbox->y, hitbox->width, hitbox->height };
+}
@@ -0,0 +1,219 @@
+// background loader for assets you are likely to need soon (like portal destinations, or the sounds on a map)
+// assets are loaded (with the cache's AssetLoadFn) on a worker thread, then published into the cache on the main thread
+// (in adventure_prefetch_update), so when you actually switch maps, it's already built.
+// it works with any asset_cache_t whose loader is ok to run off the main thread, each prefetcher has its own worker
+// (anything that has to be made on the main thread goes in the cache's AssetFinishFn, which runs when it's published)
+// on web (and windows) there is no worker, so requests are loaded one per adventure_prefetch_update() instead
+// define ADVENTURE_PREFETCH_NO_THREADS to get that everywhere (like for repeatable benchmarks)
+
+#if !defined(__EMSCRIPTEN__) && !defined(_WIN32) && !defined(ADVENTURE_PREFETCH_NO_THREADS)
+#define ADVENTURE_PREFETCH_THREADED
+#include <pthread.h>
+#endif
+
+#ifndef ADVENTURE_PREFETCH_MAX
+#define ADVENTURE_PREFETCH_MAX 32
+#endif
+
+typedef enum adventure_prefetch_state_t {
+    ADVENTURE_PREFETCH_EMPTY = 0,
+    ADVENTURE_PREFETCH_QUEUED,
+    ADVENTURE_PREFETCH_LOADING,
+    ADVENTURE_PREFETCH_DONE
+} adventure_prefetch_state_t;
+
+typedef struct adventure_prefetch_job_t {
+    adventure_prefetch_state_t state;
+    asset_handle_t handle;
+    char filename[PNTR_PATH_MAX];
+    void* data;
+    size_t bytes;
+} adventure_prefetch_job_t;
+
+typedef struct adventure_prefetch_t {
+    asset_cache_t* cache;
+    adventure_prefetch_job_t jobs[ADVENTURE_PREFETCH_MAX];
+#ifdef ADVENTURE_PREFETCH_THREADED
+    pthread_t thread;
+    pthread_mutex_t lock;
+    pthread_cond_t wake;  // worker waits on this for work
+    pthread_cond_t done;  // main waits on this in adventure_prefetch_wait
+    bool running;
+#endif
+} adventure_prefetch_t;
+
+// load a job (on worker, or main thread on web)
+static void adventure_prefetch_build(adventure_prefetch_t* prefetch, adventure_prefetch_job_t* job) {
+    job->bytes = 0;
+    job->data = prefetch->cache->load(job->filename, prefetch->cache->userdata, &job->bytes);
+}
+
+#ifdef ADVENTURE_PREFETCH_THREADED
+static void* adventure_prefetch_worker(void* userdata) {
+    adventure_prefetch_t* prefetch = (adventure_prefetch_t*)userdata;
+    pthread_mutex_lock(&prefetch->lock);
+    while (prefetch->running) {
+        adventure_prefetch_job_t* job = NULL;
+        for (int i = 0; i < ADVENTURE_PREFETCH_MAX; i++) {
+            if (prefetch->jobs[i].state == ADVENTURE_PREFETCH_QUEUED) {
+                job = &prefetch->jobs[i];
+                break;
+            }
+        }
+        if (job == NULL) {
+            pthread_cond_wait(&prefetch->wake, &prefetch->lock);
+            continue;
+        }
+        job->state = ADVENTURE_PREFETCH_LOADING;
+
+        // parse without holding the lock, the main thread does not touch LOADING jobs
+        pthread_mutex_unlock(&prefetch->lock);
+        adventure_prefetch_build(prefetch, job);
+        pthread_mutex_lock(&prefetch->lock);
+
+        job->state = ADVENTURE_PREFETCH_DONE;
+        pthread_cond_broadcast(&prefetch->done);
+    }
+    pthread_mutex_unlock(&prefetch->lock);
+    return NULL;
+}
+#endif
+
+// start the loader, for a cache (of maps, sounds, etc)
+void adventure_prefetch_init(adventure_prefetch_t* prefetch, asset_cache_t* cache) {
+    memset(prefetch, 0, sizeof(adventure_prefetch_t));
+    prefetch->cache = cache;
+#ifdef ADVENTURE_PREFETCH_THREADED
+    pthread_mutex_init(&prefetch->lock, NULL);
+    pthread_cond_init(&prefetch->wake, NULL);
+    pthread_cond_init(&prefetch->done, NULL);
+    prefetch->running = true;
+    if (pthread_create(&prefetch->thread, NULL, adventure_prefetch_worker, prefetch) != 0) {
+        pntr_app_log(PNTR_APP_LOG_WARNING, "Prefetch: could not start worker, loading on main thread.");
+        prefetch->running = false;
+    }
+#endif
+}
+
+static inline void adventure_prefetch_lock(adventure_prefetch_t* prefetch) {
+#ifdef ADVENTURE_PREFETCH_THREADED
+    pthread_mutex_lock(&prefetch->lock);
+#endif
+}
+
+static inline void adventure_prefetch_unlock(adventure_prefetch_t* prefetch) {
+#ifdef ADVENTURE_PREFETCH_THREADED
+    pthread_mutex_unlock(&prefetch->lock);
+#endif
+}
+
+// hand a finished job to the cache (call with lock held)
+static void adventure_prefetch_publish(adventure_prefetch_t* prefetch, adventure_prefetch_job_t* job) {
+    if (job->data != NULL && prefetch->cache->finish != NULL) {
+        prefetch->cache->finish(job->data, prefetch->cache->userdata);
+    }
+    if (job->data != NULL && !asset_cache_put(prefetch->cache, job->handle, job->data, job->bytes)) {
+        // it was loaded some other way in the meantime
+        prefetch->cache->unload(job->data, prefetch->cache->userdata);
+    }
+    memset(job, 0, sizeof(adventure_prefetch_job_t));
+}
+
+// ask for an asset to be loaded in the background (does nothing if it's loaded or already queued)
+void adventure_prefetch_request(adventure_prefetch_t* prefetch, asset_handle_t handle) {
+    const char* filename = asset_cache_key(prefetch->cache, handle);
+    if (filename == NULL || asset_cache_loaded(prefetch->cache, handle)) {
+        return;
+    }
+    adventure_prefetch_lock(prefetch);
+    adventure_prefetch_job_t* free_job = NULL;
+    for (int i = 0; i < ADVENTURE_PREFETCH_MAX; i++) {
+        adventure_prefetch_job_t* job = &prefetch->jobs[i];
+        if (job->state != ADVENTURE_PREFETCH_EMPTY && job->handle == handle) {
+            adventure_prefetch_unlock(prefetch);
+            return;
+        }
+        if (free_job == NULL && job->state == ADVENTURE_PREFETCH_EMPTY) {
+            free_job = job;
+        }
+    }
+    if (free_job != NULL) {
+        free_job->handle = handle;
+        snprintf(free_job->filename, PNTR_PATH_MAX, "%s", filename);
+        free_job->state = ADVENTURE_PREFETCH_QUEUED;
+#ifdef ADVENTURE_PREFETCH_THREADED
+        pthread_cond_signal(&prefetch->wake);
+#endif
+    }
+    adventure_prefetch_unlock(prefetch);
+}
+
+// publish finished assets into the cache (call once per frame, on main thread)
+// without a worker, this loads one queued asset per call
+void adventure_prefetch_update(adventure_prefetch_t* prefetch) {
+    adventure_prefetch_lock(prefetch);
+    bool loaded_one = false;
+    for (int i = 0; i < ADVENTURE_PREFETCH_MAX; i++) {
+        adventure_prefetch_job_t* job = &prefetch->jobs[i];
+#ifdef ADVENTURE_PREFETCH_THREADED
+        if (!prefetch->running && job->state == ADVENTURE_PREFETCH_QUEUED && !loaded_one) {
+#else
+        if (job->state == ADVENTURE_PREFETCH_QUEUED && !loaded_one) {
+#endif
+            adventure_prefetch_build(prefetch, job);
+            job->state = ADVENTURE_PREFETCH_DONE;
+            loaded_one = true;
+        }
+        if (job->state == ADVENTURE_PREFETCH_DONE) {
+            adventure_prefetch_publish(prefetch, job);
+        }
+    }
+    adventure_prefetch_unlock(prefetch);
+}
+
+// make sure an asset is not still loading in the background (call before you use it)
+// if it is queued or loading, this waits for it and publishes it
+void adventure_prefetch_wait(adventure_prefetch_t* prefetch, asset_handle_t handle) {
+    adventure_prefetch_lock(prefetch);
+    for (int i = 0; i < ADVENTURE_PREFETCH_MAX; i++) {
+        adventure_prefetch_job_t* job = &prefetch->jobs[i];
+        if (job->state == ADVENTURE_PREFETCH_EMPTY || job->handle != handle) {
+            continue;
+        }
+#ifdef ADVENTURE_PREFETCH_THREADED
+        if (prefetch->running) {
+            while (job->state != ADVENTURE_PREFETCH_DONE) {
+                pthread_cond_wait(&prefetch->done, &prefetch->lock);
+            }
+        }
+#endif
+        if (job->state == ADVENTURE_PREFETCH_QUEUED) {
+            adventure_prefetch_build(prefetch, job);
+            job->state = ADVENTURE_PREFETCH_DONE;
+        }
+        adventure_prefetch_publish(prefetch, job);
+    }
+    adventure_prefetch_unlock(prefetch);
+}
+
+// stop worker & free anything that was never published
+void adventure_prefetch_unload(adventure_prefetch_t* prefetch) {
+#ifdef ADVENTURE_PREFETCH_THREADED
+    if (prefetch->running) {
+        pthread_mutex_lock(&prefetch->lock);
+        prefetch->running = false;
+        pthread_cond_broadcast(&prefetch->wake);
+        pthread_mutex_unlock(&prefetch->lock);
+        pthread_join(prefetch->thread, NULL);
+    }
+    pthread_mutex_destroy(&prefetch->lock);
+    pthread_cond_destroy(&prefetch->wake);
+    pthread_cond_destroy(&prefetch->done);
+#endif
+    for (int i = 0; i < ADVENTURE_PREFETCH_MAX; i++) {
+        if (prefetch->jobs[i].data != NULL) {
+            prefetch->cache->unload(prefetch->jobs[i].data, prefetch->cache->userdata);
+        }
+    }
+    memset(prefetch, 0, sizeof(adventure_prefetch_t));
+}
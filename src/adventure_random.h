@@ -0,0 +1,55 @@
+// small, fast & repeatable random numbers (splitmix64)
+// a stream is just a counter, each number is the counter run through a mixer, so streams are cheap to make
+// every entity gets its own stream (seeded from map & object id, see adventure_entities_seed) so what one NPC rolls
+// doesn't depend on how many others there are, what order they update in, or which thread does it
+
+// added to every map's seed, change it to get different (but still repeatable) runs
+#ifndef ADVENTURE_RANDOM_SEED
+#define ADVENTURE_RANDOM_SEED 0
+#endif
+
+typedef uint64_t adventure_random_t;
+
+// scramble 64 bits (splitmix64 finalizer)
+static inline uint64_t adventure_random_mix(uint64_t x) {
+    x ^= x >> 30;
+    x *= 0xBF58476D1CE4E5B9ull;
+    x ^= x >> 27;
+    x *= 0x94D049BB133111EBull;
+    x ^= x >> 31;
+    return x;
+}
+
+// seed from a string (FNV-1a), like a map's filename
+static inline uint64_t adventure_random_hash(const char* text) {
+    uint64_t hash = 0xCBF29CE484222325ull;
+    for (const char* c = text; c != NULL && *c; c++) {
+        hash ^= (unsigned char)*c;
+        hash *= 0x100000001B3ull;
+    }
+    return hash;
+}
+
+// start a stream (same seed, same numbers)
+static inline adventure_random_t adventure_random_stream(uint64_t seed, uint64_t id) {
+    return adventure_random_mix(seed ^ adventure_random_mix(id + 0x9E3779B97F4A7C15ull));
+}
+
+// next 64 random bits
+static inline uint64_t adventure_random_next(adventure_random_t* random) {
+    *random += 0x9E3779B97F4A7C15ull;
+    return adventure_random_mix(*random);
+}
+
+// int in [min, max]
+static inline int adventure_random_int(adventure_random_t* random, int min, int max) {
+    if (max <= min) {
+        return min;
+    }
+    return min + (int)(adventure_random_next(random) % (uint64_t)((int64_t)max - min + 1));
+}
+
+// float in [min, max)
+static inline float adventure_random_float(adventure_random_t* random, float min, float max) {
+    return min + (float)(adventure_random_next(random) >> 40) * (1.0f / 16777216.0f) * (max - min);
+}
@@ -0,0 +1,144 @@
+// bump-allocator: lots of small allocations out of a few big blocks, freed all at once
+// a map keeps everything it owns in one (so unloading it is a single reset), caches keep their keys in one
+// & the game has a per-frame scratch one for things that only live until the next frame
+// allocations are zeroed & 16-byte aligned, there is no free for a single allocation
+// blocks never move, so pointers stay good until the arena is reset (or rewound past them)
+// not thread-safe: one thread uses an arena at a time
+
+#ifndef ARENA_ALIGN
+#define ARENA_ALIGN 16
+#endif
+
+// default size of a block, if the arena doesn't say
+#ifndef ARENA_BLOCK_SIZE
+#define ARENA_BLOCK_SIZE (16 * 1024)
+#endif
+
+#define ARENA_ROUND(size) (((size) + (ARENA_ALIGN - 1)) & ~(size_t)(ARENA_ALIGN - 1))
+
+typedef struct arena_block_t {
+    struct arena_block_t* next;
+    size_t size;    // usable bytes (after the header)
+    size_t used;
+} arena_block_t;
+
+typedef struct arena_t {
+    arena_block_t* first;
+    arena_block_t* current;     // blocks after this one are empty (kept from before a reset)
+    size_t block_size;          // size of new blocks (bigger allocations get a block of their own size)
+    size_t bytes;               // total size of all blocks
+} arena_t;
+
+// a place to rewind to (see arena_mark)
+typedef struct arena_mark_t {
+    arena_block_t* block;
+    size_t used;
+} arena_mark_t;
+
+static inline unsigned char* arena_block_data(arena_block_t* block) {
+    return (unsigned char*)block + ARENA_ROUND(sizeof(arena_block_t));
+}
+
+// set up an arena, it doesn't allocate anything until it's used (0 for default block_size)
+void arena_init(arena_t* arena, size_t block_size) {
+    memset(arena, 0, sizeof(arena_t));
+    arena->block_size = block_size ? ARENA_ROUND(block_size) : ARENA_BLOCK_SIZE;
+}
+
+// make sure the current block has room for size bytes (so the next allocations don't need a new block)
+bool arena_reserve(arena_t* arena, size_t size) {
+    size = ARENA_ROUND(size);
+    if (arena->current != NULL && arena->current->size - arena->current->used >= size) {
+        return true;
+    }
+
+    // an empty block kept from before a reset might be big enough
+    for (arena_block_t* block = arena->current != NULL ? arena->current->next : arena->first; block != NULL; block = block->next) {
+        if (block->size >= size) {
+            arena->current = block;
+            return true;
+        }
+    }
+
+    size_t block_size = MAX(size, arena->block_size);
+    arena_block_t* block = pntr_load_memory(ARENA_ROUND(sizeof(arena_block_t)) + block_size);
+    if (block == NULL) {
+        return false;
+    }
+    block->size = block_size;
+    block->used = 0;
+    arena->bytes += block_size;
+
+    // goes right after current, so the empty ones after it stay after it
+    if (arena->current == NULL) {
+        block->next = arena->first;
+        arena->first = block;
+    } else {
+        block->next = arena->current->next;
+        arena->current->next = block;
+    }
+    arena->current = block;
+    return true;
+}
+
+// get size bytes (zeroed), NULL if out of memory
+void* arena_alloc(arena_t* arena, size_t size) {
+    if (arena == NULL || !arena_reserve(arena, size)) {
+        return NULL;
+    }
+    size = ARENA_ROUND(size);
+    unsigned char* mem = arena_block_data(arena->current) + arena->current->used;
+    arena->current->used += size;
+    memset(mem, 0, size);
+    return mem;
+}
+
+// copy a string into the arena
+char* arena_strdup(arena_t* arena, const char* str) {
+    if (str == NULL) {
+        return NULL;
+    }
+    size_t size = PNTR_STRLEN(str) + 1;
+    char* copy = arena_alloc(arena, size);
+    if (copy != NULL) {
+        memcpy(copy, str, size);
+    }
+    return copy;
+}
+
+// remember how much is used now, to rewind to later
+arena_mark_t arena_mark(arena_t* arena) {
+    arena_mark_t mark = { arena->current, arena->current ? arena->current->used : 0 };
+    return mark;
+}
+
+// free everything allocated since mark (blocks are kept for next time)
+void arena_rewind(arena_t* arena, arena_mark_t mark) {
+    arena_block_t* block = mark.block != NULL ? mark.block->next : arena->first;
+    for (; block != NULL; block = block->next) {
+        block->used = 0;
+    }
+    if (mark.block != NULL) {
+        mark.block->used = mark.used;
+    }
+    arena->current = mark.block;
+}
+
+// free everything, but keep the blocks to use again
+void arena_reset(arena_t* arena) {
+    arena_mark_t start = {0};
+    arena_rewind(arena, start);
+}
+
+// give all memory back
+void arena_unload(arena_t* arena) {
+    arena_block_t* block = arena->first;
+    while (block != NULL) {
+        arena_block_t* next = block->next;
+        pntr_unload_memory(block);
+        block = next;
+    }
+    size_t block_size = arena->block_size;
+    memset(arena, 0, sizeof(arena_t));
+    arena->block_size = block_size;
+}
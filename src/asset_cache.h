@@ -0,0 +1,291 @@
+// this is a cache for assets (maps, sounds) keyed on filename
+// filenames are interned into a hash-table once, and you get a handle back that stays valid,
+// so you can hold on to that and skip the lookup entirely.
+// assets are loaded on first use, reference-counted, and the least-recently-used ones
+// that nobody holds are unloaded when the cache goes over its memory budget.
+
+// handle to an interned key (slot-index + 1), 0 is never a valid handle
+typedef uint32_t asset_handle_t;
+
+// load an asset, and report how much memory it uses
+typedef void* (*AssetLoadFn)(const char* key, void* userdata, size_t* bytes);
+
+// unload an asset
+typedef void (*AssetUnloadFn)(void* data, void* userdata);
+
+// finish a loaded asset on the main thread, for the parts that can't be made on another one (like audio-objects)
+typedef void (*AssetFinishFn)(void* data, void* userdata);
+
+typedef struct asset_slot_t {
+    char* key;
+    uint32_t hash;
+    void* data;         // NULL if not loaded (yet, or evicted)
+    size_t bytes;
+    int refs;
+    uint64_t last_used;
+} asset_slot_t;
+
+typedef struct asset_cache_t {
+    asset_slot_t* slots;
+    int count;
+    int capacity;
+
+    // open-addressing (linear probe) table of slot-index+1, 0 is empty
+    int* table;
+    int table_size;     // power of 2, at least 2x capacity
+
+    size_t bytes;       // total of loaded assets
+    size_t budget;      // 0 for unlimited
+    uint64_t tick;
+
+    AssetLoadFn load;
+    AssetUnloadFn unload;
+    AssetFinishFn finish;   // optional, called before an asset goes in the cache (loads can run on a worker, see adventure_prefetch.h)
+    void* userdata;
+
+    arena_t keys;       // interned keys live as long as the cache
+} asset_cache_t;
+
+// FNV-1a
+static uint32_t asset_hash(const char* key) {
+    uint32_t hash = 2166136261u;
+    while (*key) {
+        hash ^= (unsigned char)*key++;
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+static void asset_cache_rehash(asset_cache_t* cache, int table_size) {
+    if (cache->table != NULL) {
+        pntr_unload_memory(cache->table);
+    }
+    cache->table_size = table_size;
+    cache->table = pntr_load_memory(sizeof(int) * table_size);
+    memset(cache->table, 0, sizeof(int) * table_size);
+    for (int i = 0; i < cache->count; i++) {
+        int pos = cache->slots[i].hash & (table_size - 1);
+        while (cache->table[pos] != 0) {
+            pos = (pos + 1) & (table_size - 1);
+        }
+        cache->table[pos] = i + 1;
+    }
+}
+
+// set up a cache, budget is in bytes (0 for unlimited)
+void asset_cache_init(asset_cache_t* cache, int capacity, size_t budget, AssetLoadFn load, AssetUnloadFn unload, void* userdata) {
+    memset(cache, 0, sizeof(asset_cache_t));
+    cache->capacity = MAX(capacity, 4);
+    cache->slots = pntr_load_memory(sizeof(asset_slot_t) * cache->capacity);
+    memset(cache->slots, 0, sizeof(asset_slot_t) * cache->capacity);
+    cache->budget = budget;
+    cache->load = load;
+    cache->unload = unload;
+    cache->userdata = userdata;
+    arena_init(&cache->keys, 0);
+
+    int table_size = 8;
+    while (table_size < cache->capacity * 2) {
+        table_size *= 2;
+    }
+    asset_cache_rehash(cache, table_size);
+}
+
+static inline asset_handle_t asset_cache_handle(asset_cache_t* cache, int index) {
+    return (asset_handle_t)(index + 1);
+}
+
+static asset_slot_t* asset_cache_slot(asset_cache_t* cache, asset_handle_t handle) {
+    int index = (int)handle - 1;
+    if (cache == NULL || index < 0 || index >= cache->count) {
+        return NULL;
+    }
+    return &cache->slots[index];
+}
+
+// get a stable handle for a key, without loading it
+asset_handle_t asset_cache_intern(asset_cache_t* cache, const char* key) {
+    if (cache == NULL || key == NULL) {
+        return 0;
+    }
+    uint32_t hash = asset_hash(key);
+    int pos = hash & (cache->table_size - 1);
+    while (cache->table[pos] != 0) {
+        asset_slot_t* slot = &cache->slots[cache->table[pos] - 1];
+        if (slot->hash == hash && PNTR_STRCMP(slot->key, key) == 0) {
+            return asset_cache_handle(cache, cache->table[pos] - 1);
+        }
+        pos = (pos + 1) & (cache->table_size - 1);
+    }
+
+    if (cache->count == cache->capacity) {
+        int capacity = cache->capacity * 2;
+        asset_slot_t* slots = pntr_load_memory(sizeof(asset_slot_t) * capacity);
+        memset(slots, 0, sizeof(asset_slot_t) * capacity);
+        memcpy(slots, cache->slots, sizeof(asset_slot_t) * cache->count);
+        pntr_unload_memory(cache->slots);
+        cache->slots = slots;
+        cache->capacity = capacity;
+    }
+
+    int index = cache->count++;
+    asset_slot_t* slot = &cache->slots[index];
+    slot->key = arena_strdup(&cache->keys, key);
+    slot->hash = hash;
+
+    if (cache->count * 2 > cache->table_size) {
+        asset_cache_rehash(cache, cache->table_size * 2);
+    } else {
+        cache->table[pos] = index + 1;
+    }
+    return asset_cache_handle(cache, index);
+}
+
+// the key a handle was interned with
+const char* asset_cache_key(asset_cache_t* cache, asset_handle_t handle) {
+    asset_slot_t* slot = asset_cache_slot(cache, handle);
+    return slot == NULL ? NULL : slot->key;
+}
+
+static void asset_cache_drop(asset_cache_t* cache, asset_slot_t* slot) {
+    if (slot->data != NULL) {
+        if (cache->unload != NULL) {
+            cache->unload(slot->data, cache->userdata);
+        }
+        slot->data = NULL;
+        cache->bytes -= slot->bytes;
+        slot->bytes = 0;
+    }
+}
+
+// unload least-recently-used assets, that nobody holds a reference to, until under budget
+// keep is never unloaded (the one you just asked for)
+void asset_cache_trim(asset_cache_t* cache, asset_slot_t* keep) {
+    while (cache->budget != 0 && cache->bytes > cache->budget) {
+        asset_slot_t* oldest = NULL;
+        for (int i = 0; i < cache->count; i++) {
+            asset_slot_t* slot = &cache->slots[i];
+            if (slot != keep && slot->data != NULL && slot->refs == 0 && (oldest == NULL || slot->last_used < oldest->last_used)) {
+                oldest = slot;
+            }
+        }
+        if (oldest == NULL) {
+            return;
+        }
+        asset_cache_drop(cache, oldest);
+    }
+}
+
+// an asset's memory-use changed after it was loaded (like a map drawing or freeing chunk-images)
+// growing can unload other assets, if that puts the cache over budget (never this one)
+void asset_cache_resize(asset_cache_t* cache, asset_handle_t handle, size_t bytes) {
+    asset_slot_t* slot = asset_cache_slot(cache, handle);
+    if (slot == NULL || slot->data == NULL) {
+        return;
+    }
+    cache->bytes = cache->bytes - slot->bytes + bytes;
+    slot->bytes = bytes;
+    asset_cache_trim(cache, slot);
+}
+
+// change the memory budget (0 for unlimited)
+void asset_cache_set_budget(asset_cache_t* cache, size_t budget) {
+    cache->budget = budget;
+    asset_cache_trim(cache, NULL);
+}
+
+// get the asset for a handle, loading it if needed
+void* asset_cache_get(asset_cache_t* cache, asset_handle_t handle) {
+    asset_slot_t* slot = asset_cache_slot(cache, handle);
+    if (slot == NULL) {
+        return NULL;
+    }
+    slot->last_used = ++cache->tick;
+    if (slot->data == NULL && cache->load != NULL) {
+        size_t bytes = 0;
+        slot->data = cache->load(slot->key, cache->userdata, &bytes);
+        if (slot->data != NULL && cache->finish != NULL) {
+            cache->finish(slot->data, cache->userdata);
+        }
+        if (slot->data != NULL) {
+            slot->bytes = bytes;
+            cache->bytes += bytes;
+            asset_cache_trim(cache, slot);
+        }
+    }
+    return slot->data;
+}
+
+// is the asset for a handle loaded right now?
+bool asset_cache_loaded(asset_cache_t* cache, asset_handle_t handle) {
+    asset_slot_t* slot = asset_cache_slot(cache, handle);
+    return slot != NULL && slot->data != NULL;
+}
+
+// hand the cache an asset you loaded yourself (like on another thread)
+// returns false (and does not take it) if that handle is already loaded
+bool asset_cache_put(asset_cache_t* cache, asset_handle_t handle, void* data, size_t bytes) {
+    asset_slot_t* slot = asset_cache_slot(cache, handle);
+    if (slot == NULL || slot->data != NULL || data == NULL) {
+        return false;
+    }
+    slot->data = data;
+    slot->bytes = bytes;
+    slot->last_used = ++cache->tick;
+    cache->bytes += bytes;
+    asset_cache_trim(cache, slot);
+    return true;
+}
+
+// get the asset for a key, loading it if needed
+void* asset_cache_load(asset_cache_t* cache, const char* key) {
+    return asset_cache_get(cache, asset_cache_intern(cache, key));
+}
+
+// find the handle of an already-loaded asset (0 if it isn't in the cache)
+asset_handle_t asset_cache_find(asset_cache_t* cache, void* data) {
+    for (int i = 0; data != NULL && i < cache->count; i++) {
+        if (cache->slots[i].data == data) {
+            return asset_cache_handle(cache, i);
+        }
+    }
+    return 0;
+}
+
+// hold on to an asset, so it won't be evicted (loads it if needed)
+void* asset_cache_acquire(asset_cache_t* cache, asset_handle_t handle) {
+    void* data = asset_cache_get(cache, handle);
+    if (data != NULL) {
+        asset_cache_slot(cache, handle)->refs++;
+    }
+    return data;
+}
+
+// let go of an asset, it can be evicted when nobody holds it
+void asset_cache_release(asset_cache_t* cache, asset_handle_t handle) {
+    asset_slot_t* slot = asset_cache_slot(cache, handle);
+    if (slot != NULL && slot->refs > 0) {
+        slot->refs--;
+        asset_cache_trim(cache, NULL);
+    }
+}
+
+// unload every asset (even held ones), handles stay valid & will reload on next get
+void asset_cache_unload_all(asset_cache_t* cache) {
+    for (int i = 0; i < cache->count; i++) {
+        asset_cache_drop(cache, &cache->slots[i]);
+        cache->slots[i].refs = 0;
+    }
+}
+
+// unload everything & free all memory used by cache
+void asset_cache_free(asset_cache_t* cache) {
+    if (cache == NULL || cache->slots == NULL) {
+        return;
+    }
+    asset_cache_unload_all(cache);
+    arena_unload(&cache->keys);
+    pntr_unload_memory(cache->slots);
+    pntr_unload_memory(cache->table);
+    memset(cache, 0, sizeof(asset_cache_t));
+}
@@ -0,0 +1,330 @@
+// this is a timed command queue
+// you can schedule a change to a gid, a move, a sound, a dialog or your own callback for later
+// commands live in a pool & are ordered by a binary min-heap (on fire-time), so each frame only touches what is due
+
+typedef enum command_type_t {
+    COMMAND_SET_GID,
+    COMMAND_MOVE,
+    COMMAND_PLAY_SOUND,
+    COMMAND_SHOW_DIALOG,
+    COMMAND_CALLBACK
+} command_type_t;
+
+struct command_t;
+struct command_queue_t;
+
+// called for COMMAND_CALLBACK
+typedef void (*CommandCallback)(struct command_queue_t* queue, struct command_t* command, void* userdata);
+
+// called for COMMAND_SHOW_DIALOG (the game decides what a dialog is)
+typedef void (*CommandDialogCallback)(const char* text, const char* speaker);
+
+// handle to a scheduled command: pool-index in low 16 bits, generation in high 16
+// 0 is never a valid handle
+typedef uint32_t command_handle_t;
+
+typedef struct command_t {
+    command_type_t type;
+    double time;                  // in seconds, on queue clock
+    uint16_t generation;
+    int heap_index;               // -1 when free
+
+    // target (not used by sound/dialog)
+    adventure_map_t* map;
+    int entity;
+
+    union {
+        int gid;
+        struct { float x, y; } position;
+        asset_handle_t sound;
+        struct { const char* text; const char* speaker; } dialog;
+        struct { CommandCallback fn; void* userdata; } callback;
+    } data;
+
+    int next_free;
+} command_t;
+
+typedef struct command_queue_t {
+    command_t* pool;
+    int* heap;          // pool-indexes, ordered by time
+    int count;          // pending commands
+    int capacity;
+    int free_head;
+    double time;
+    CommandDialogCallback dialog;
+    sound_mixer_t* mixer;   // COMMAND_PLAY_SOUND plays through this (nothing plays if it's NULL)
+} command_queue_t;
+
+// set up a queue with room for capacity commands (it will grow if needed, but try to size it so it doesn't)
+void command_queue_init(command_queue_t* queue, int capacity) {
+    memset(queue, 0, sizeof(command_queue_t));
+    queue->capacity = MAX(capacity, 1);
+    queue->pool = pntr_load_memory(sizeof(command_t) * queue->capacity);
+    queue->heap = pntr_load_memory(sizeof(int) * queue->capacity);
+    memset(queue->pool, 0, sizeof(command_t) * queue->capacity);
+    for (int i = 0; i < queue->capacity; i++) {
+        queue->pool[i].heap_index = -1;
+        queue->pool[i].next_free = i + 1 < queue->capacity ? i + 1 : -1;
+    }
+    queue->free_head = 0;
+}
+
+// free all memory used by queue
+void command_queue_unload(command_queue_t* queue) {
+    if (queue == NULL || queue->pool == NULL) {
+        return;
+    }
+    pntr_unload_memory(queue->pool);
+    pntr_unload_memory(queue->heap);
+    memset(queue, 0, sizeof(command_queue_t));
+}
+
+// double the pool (only happens if more commands are pending than ever before)
+static void command_queue_grow(command_queue_t* queue) {
+    int capacity = queue->capacity * 2;
+    command_t* pool = pntr_load_memory(sizeof(command_t) * capacity);
+    int* heap = pntr_load_memory(sizeof(int) * capacity);
+    memcpy(pool, queue->pool, sizeof(command_t) * queue->capacity);
+    memcpy(heap, queue->heap, sizeof(int) * queue->count);
+    memset(pool + queue->capacity, 0, sizeof(command_t) * (capacity - queue->capacity));
+    for (int i = queue->capacity; i < capacity; i++) {
+        pool[i].heap_index = -1;
+        pool[i].next_free = i + 1 < capacity ? i + 1 : queue->free_head;
+    }
+    queue->free_head = queue->capacity;
+    pntr_unload_memory(queue->pool);
+    pntr_unload_memory(queue->heap);
+    queue->pool = pool;
+    queue->heap = heap;
+    queue->capacity = capacity;
+}
+
+static inline bool command_before(command_queue_t* queue, int a, int b) {
+    return queue->pool[queue->heap[a]].time < queue->pool[queue->heap[b]].time;
+}
+
+static void command_swap(command_queue_t* queue, int a, int b) {
+    int tmp = queue->heap[a];
+    queue->heap[a] = queue->heap[b];
+    queue->heap[b] = tmp;
+    queue->pool[queue->heap[a]].heap_index = a;
+    queue->pool[queue->heap[b]].heap_index = b;
+}
+
+static void command_sift_up(command_queue_t* queue, int i) {
+    while (i > 0) {
+        int parent = (i - 1) / 2;
+        if (!command_before(queue, i, parent)) {
+            break;
+        }
+        command_swap(queue, i, parent);
+        i = parent;
+    }
+}
+
+static void command_sift_down(command_queue_t* queue, int i) {
+    for (;;) {
+        int smallest = i;
+        int left = i * 2 + 1;
+        int right = left + 1;
+        if (left < queue->count && command_before(queue, left, smallest)) {
+            smallest = left;
+        }
+        if (right < queue->count && command_before(queue, right, smallest)) {
+            smallest = right;
+        }
+        if (smallest == i) {
+            return;
+        }
+        command_swap(queue, i, smallest);
+        i = smallest;
+    }
+}
+
+// take a command out of the heap & return it to the pool
+static void command_remove_at(command_queue_t* queue, int heap_index) {
+    int index = queue->heap[heap_index];
+    queue->count--;
+    if (heap_index != queue->count) {
+        queue->heap[heap_index] = queue->heap[queue->count];
+        queue->pool[queue->heap[heap_index]].heap_index = heap_index;
+        command_sift_down(queue, heap_index);
+        command_sift_up(queue, heap_index);
+    }
+    command_t* command = &queue->pool[index];
+    command->heap_index = -1;
+    command->generation++;
+    command->next_free = queue->free_head;
+    queue->free_head = index;
+}
+
+static inline command_handle_t command_handle(command_queue_t* queue, int index) {
+    return ((uint32_t)queue->pool[index].generation << 16) | (uint32_t)(index + 1);
+}
+
+// get the command for a handle, if it's still pending
+command_t* command_get(command_queue_t* queue, command_handle_t handle) {
+    int index = (int)(handle & 0xFFFF) - 1;
+    if (queue == NULL || index < 0 || index >= queue->capacity) {
+        return NULL;
+    }
+    command_t* command = &queue->pool[index];
+    if (command->heap_index == -1 || command->generation != (uint16_t)(handle >> 16)) {
+        return NULL;
+    }
+    return command;
+}
+
+// schedule a command (fill in the type-specific data on the returned command)
+static command_t* command_schedule(command_queue_t* queue, command_type_t type, float delay, adventure_map_t* map, int entity, command_handle_t* handle) {
+    if (queue->free_head == -1) {
+        // handles only have room for 16 bits of index
+        if (queue->capacity * 2 >= 0xFFFF) {
+            pntr_app_log(PNTR_APP_LOG_WARNING, "Commands: queue is full.");
+            return NULL;
+        }
+        command_queue_grow(queue);
+    }
+    int index = queue->free_head;
+    command_t* command = &queue->pool[index];
+    queue->free_head = command->next_free;
+
+    command->type = type;
+    command->time = queue->time + delay;
+    command->map = map;
+    command->entity = entity;
+    command->heap_index = queue->count;
+    queue->heap[queue->count++] = index;
+    command_sift_up(queue, command->heap_index);
+
+    *handle = command_handle(queue, index);
+    return command;
+}
+
+// change an entity's gid, later
+command_handle_t command_set_gid(command_queue_t* queue, adventure_map_t* map, int entity, int gid, float delay) {
+    command_handle_t handle = 0;
+    command_t* command = command_schedule(queue, COMMAND_SET_GID, delay, map, entity, &handle);
+    if (command != NULL) {
+        command->data.gid = gid;
+    }
+    return handle;
+}
+
+// move an entity (world-space top-left), later
+command_handle_t command_move(command_queue_t* queue, adventure_map_t* map, int entity, float x, float y, float delay) {
+    command_handle_t handle = 0;
+    command_t* command = command_schedule(queue, COMMAND_MOVE, delay, map, entity, &handle);
+    if (command != NULL) {
+        command->data.position.x = x;
+        command->data.position.y = y;
+    }
+    return handle;
+}
+
+// play a sound (by handle, from asset_cache_intern) through queue->mixer, later
+// it's only looked up when it fires, so it can be unloaded in the meantime
+command_handle_t command_play_sound(command_queue_t* queue, asset_handle_t sound, float delay) {
+    command_handle_t handle = 0;
+    command_t* command = command_schedule(queue, COMMAND_PLAY_SOUND, delay, NULL, -1, &handle);
+    if (command != NULL) {
+        command->data.sound = sound;
+    }
+    return handle;
+}
+
+// show a dialog (through queue->dialog), later
+// text/speaker are not copied, so they need to outlive the command
+command_handle_t command_show_dialog(command_queue_t* queue, const char* text, const char* speaker, float delay) {
+    command_handle_t handle = 0;
+    command_t* command = command_schedule(queue, COMMAND_SHOW_DIALOG, delay, NULL, -1, &handle);
+    if (command != NULL) {
+        command->data.dialog.text = text;
+        command->data.dialog.speaker = speaker;
+    }
+    return handle;
+}
+
+// call your own function, later (map/entity are optional, and passed along on the command)
+command_handle_t command_callback(command_queue_t* queue, CommandCallback fn, void* userdata, adventure_map_t* map, int entity, float delay) {
+    command_handle_t handle = 0;
+    command_t* command = command_schedule(queue, COMMAND_CALLBACK, delay, map, entity, &handle);
+    if (command != NULL) {
+        command->data.callback.fn = fn;
+        command->data.callback.userdata = userdata;
+    }
+    return handle;
+}
+
+// cancel a pending command, returns false if it already ran (or was cancelled)
+bool command_cancel(command_queue_t* queue, command_handle_t handle) {
+    command_t* command = command_get(queue, handle);
+    if (command == NULL) {
+        return false;
+    }
+    command_remove_at(queue, command->heap_index);
+    return true;
+}
+
+// find the next pending command that targets an entity (0 if none)
+command_handle_t command_find(command_queue_t* queue, adventure_map_t* map, int entity) {
+    int found = -1;
+    for (int i = 0; i < queue->capacity; i++) {
+        command_t* command = &queue->pool[i];
+        if (command->heap_index != -1 && command->map == map && command->entity == entity && (found == -1 || command->time < queue->pool[found].time)) {
+            found = i;
+        }
+    }
+    return found == -1 ? 0 : command_handle(queue, found);
+}
+
+// cancel everything targeting an entity (or a whole map, if entity is -1)
+// do this before unloading a map that has pending commands
+int command_cancel_entity(command_queue_t* queue, adventure_map_t* map, int entity) {
+    int cancelled = 0;
+    for (int i = 0; i < queue->capacity; i++) {
+        command_t* command = &queue->pool[i];
+        if (command->heap_index != -1 && command->map == map && (entity == -1 || command->entity == entity)) {
+            command_remove_at(queue, command->heap_index);
+            cancelled++;
+        }
+    }
+    return cancelled;
+}
+
+// run any due commands (called every frame)
+void command_queue_run(command_queue_t* queue, float dt) {
+    queue->time += dt;
+    while (queue->count > 0 && queue->pool[queue->heap[0]].time <= queue->time) {
+        int index = queue->heap[0];
+        // copy out, so callbacks can schedule/cancel freely
+        command_t command = queue->pool[index];
+        command_remove_at(queue, 0);
+
+        switch (command.type) {
+            case COMMAND_SET_GID:
+                command.map->entities.gid[command.entity] = command.data.gid;
+                break;
+            case COMMAND_MOVE:
+                command.map->entities.x[command.entity] = command.data.position.x;
+                command.map->entities.y[command.entity] = command.data.position.y;
+                adventure_grid_update(&command.map->grid, &command.map->entities, command.entity);
+                break;
+            case COMMAND_PLAY_SOUND:
+                if (queue->mixer != NULL) {
+                    sound_mixer_play(queue->mixer, command.data.sound);
+                }
+                break;
+            case COMMAND_SHOW_DIALOG:
+                if (queue->dialog != NULL) {
+                    queue->dialog(command.data.dialog.text, command.data.dialog.speaker);
+                }
+                break;
+            case COMMAND_CALLBACK:
+                if (command.data.callback.fn != NULL) {
+                    command.data.callback.fn(queue, &command, command.data.callback.userdata);
+                }
+                break;
+        }
+    }
+}
@@ -0,0 +1,159 @@
+// records what the player pressed (and how long each frame was) to a file, and plays it back
+// with the same seed, map & tick-rate the simulation then does exactly the same thing, so a bad session becomes a repeatable benchmark
+// (replay it in lop_headless to get timings, faster than real-time)
+//
+// file: "LOPR", version (u32), seed (u64), tick-rate (f32), start-map (u16 length + chars), then 1 entry per frame:
+//   u8 buttons (low 7 bits), top bit set if the frame was as long as the last one, otherwise an f32 frame-length follows
+// all little-endian
+
+#define INPUT_RECORD_VERSION 1
+
+// logical buttons (key or gamepad, the game does not care which)
+typedef enum input_button_t {
+    INPUT_UP = 1 << 0,
+    INPUT_DOWN = 1 << 1,
+    INPUT_LEFT = 1 << 2,
+    INPUT_RIGHT = 1 << 3,
+    INPUT_ACTION = 1 << 4
+} input_button_t;
+
+#define INPUT_RECORD_SAME_DT 0x80
+
+typedef enum input_record_mode_t {
+    INPUT_RECORD_OFF = 0,
+    INPUT_RECORD_WRITE,
+    INPUT_RECORD_READ
+} input_record_mode_t;
+
+typedef struct input_record_t {
+    input_record_mode_t mode;
+    uint64_t seed;
+    float tick_rate;
+    char map[PNTR_PATH_MAX];
+    uint32_t frame;     // frames written/read so far
+    float last_dt;
+
+    // write: file is appended to every frame
+    FILE* file;
+
+    // read: whole file is in memory
+    unsigned char* data;
+    unsigned int size;
+    unsigned int pos;
+} input_record_t;
+
+static void input_record_put(input_record_t* record, const void* data, size_t size) {
+    fwrite(data, 1, size, record->file);
+}
+
+static bool input_record_get(input_record_t* record, void* data, size_t size) {
+    if (record->pos + size > record->size) {
+        return false;
+    }
+    memcpy(data, record->data + record->pos, size);
+    record->pos += (unsigned int)size;
+    return true;
+}
+
+// start recording to a file
+bool input_record_start(input_record_t* record, const char* filename, uint64_t seed, float tick_rate, const char* map) {
+    memset(record, 0, sizeof(input_record_t));
+    record->file = fopen(filename, "wb");
+    if (record->file == NULL) {
+        pntr_app_log_ex(PNTR_APP_LOG_WARNING, "Record: could not write '%s'", filename);
+        return false;
+    }
+    record->mode = INPUT_RECORD_WRITE;
+    record->seed = seed;
+    record->tick_rate = tick_rate;
+    strncpy(record->map, map, PNTR_PATH_MAX - 1);
+    record->last_dt = -1;
+
+    uint32_t version = INPUT_RECORD_VERSION;
+    uint16_t length = (uint16_t)strlen(map);
+    input_record_put(record, "LOPR", 4);
+    input_record_put(record, &version, sizeof(version));
+    input_record_put(record, &seed, sizeof(seed));
+    input_record_put(record, &tick_rate, sizeof(tick_rate));
+    input_record_put(record, &length, sizeof(length));
+    input_record_put(record, map, length);
+    return true;
+}
+
+// load a recording to play back (seed, tick_rate & map are filled in, set the game up with them before the first frame)
+bool input_record_replay(input_record_t* record, const char* filename) {
+    memset(record, 0, sizeof(input_record_t));
+    record->data = pntr_load_file(filename, &record->size);
+    if (record->data == NULL) {
+        pntr_app_log_ex(PNTR_APP_LOG_WARNING, "Record: could not read '%s'", filename);
+        return false;
+    }
+
+    char magic[4];
+    uint32_t version = 0;
+    uint16_t length = 0;
+    bool valid = input_record_get(record, magic, 4) && memcmp(magic, "LOPR", 4) == 0
+        && input_record_get(record, &version, sizeof(version)) && version == INPUT_RECORD_VERSION
+        && input_record_get(record, &record->seed, sizeof(record->seed))
+        && input_record_get(record, &record->tick_rate, sizeof(record->tick_rate))
+        && input_record_get(record, &length, sizeof(length)) && length < PNTR_PATH_MAX
+        && input_record_get(record, record->map, length);
+    if (!valid) {
+        pntr_app_log_ex(PNTR_APP_LOG_WARNING, "Record: '%s' is not a recording (version %d)", filename, INPUT_RECORD_VERSION);
+        pntr_unload_file(record->data);
+        memset(record, 0, sizeof(input_record_t));
+        return false;
+    }
+    record->map[length] = 0;
+    record->mode = INPUT_RECORD_READ;
+    return true;
+}
+
+// call once per frame, before anything reads input
+// writing: saves buttons & dt, reading: replaces them with what was recorded
+// returns false once a replay runs out (it's turned off, and buttons/dt are left as they were)
+bool input_record_frame(input_record_t* record, uint8_t* buttons, float* dt) {
+    if (record->mode == INPUT_RECORD_WRITE) {
+        uint8_t entry = *buttons & 0x7F;
+        if (*dt == record->last_dt) {
+            entry |= INPUT_RECORD_SAME_DT;
+            input_record_put(record, &entry, 1);
+        } else {
+            input_record_put(record, &entry, 1);
+            input_record_put(record, dt, sizeof(float));
+            record->last_dt = *dt;
+        }
+        record->frame++;
+        return true;
+    }
+
+    if (record->mode == INPUT_RECORD_READ) {
+        uint8_t entry = 0;
+        float frame_dt = record->last_dt;
+        if (!input_record_get(record, &entry, 1) || (!(entry & INPUT_RECORD_SAME_DT) && !input_record_get(record, &frame_dt, sizeof(float)))) {
+            pntr_app_log_ex(PNTR_APP_LOG_INFO, "Record: replay finished after %d frames", record->frame);
+            pntr_unload_file(record->data);
+            record->data = NULL;
+            record->mode = INPUT_RECORD_OFF;
+            return false;
+        }
+        *buttons = entry & 0x7F;
+        *dt = frame_dt;
+        record->last_dt = frame_dt;
+        record->frame++;
+        return true;
+    }
+
+    return true;
+}
+
+// finish writing (or drop a replay)
+void input_record_stop(input_record_t* record) {
+    if (record->file != NULL) {
+        fclose(record->file);
+    }
+    if (record->data != NULL) {
+        pntr_unload_file(record->data);
+    }
+    memset(record, 0, sizeof(input_record_t));
+}
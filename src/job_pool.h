@@ -0,0 +1,212 @@
+// small work-stealing job pool, for running a loop over lots of items on every core
+// job_pool_for() splits [0, count) into batches & gives each thread (the calling thread is one of them) an even share of them
+// a thread that runs out steals half of what is left from another one, so uneven work (like NPCs near vs far from the player) still balances
+// jobs must only read shared state & write their own items, apply the results after job_pool_for returns
+// on web (and windows), or if you define JOB_POOL_NO_THREADS, it's a plain loop on the calling thread
+
+#if !defined(__EMSCRIPTEN__) && !defined(_WIN32) && !defined(JOB_POOL_NO_THREADS)
+#define JOB_POOL_THREADED
+#include <pthread.h>
+#include <sched.h>
+#include <stdatomic.h>
+#include <unistd.h>
+#endif
+
+#ifndef JOB_POOL_MAX_THREADS
+#define JOB_POOL_MAX_THREADS 16
+#endif
+
+// run a job for items [begin, end)
+typedef void (*JobPoolFn)(void* userdata, int begin, int end);
+
+struct job_pool_t;
+
+// what a worker-thread gets started with
+typedef struct job_pool_worker_t {
+    struct job_pool_t* pool;
+    int index;
+} job_pool_worker_t;
+
+typedef struct job_pool_t {
+    int thread_count;   // including the calling thread, 1 if there are no workers
+
+#ifdef JOB_POOL_THREADED
+    pthread_t threads[JOB_POOL_MAX_THREADS];
+    job_pool_worker_t workers[JOB_POOL_MAX_THREADS];
+    pthread_mutex_t lock;
+    pthread_cond_t wake;    // workers wait on this for the next loop
+    uint32_t generation;    // bumped for each loop
+    bool running;
+
+    // current loop
+    JobPoolFn fn;
+    void* userdata;
+    int count;
+    int batch;
+
+    _Atomic uint64_t ranges[JOB_POOL_MAX_THREADS];  // per thread: batches it still owns, begin in low 32 bits, end in high 32
+    atomic_int pending;     // batches not done yet
+    atomic_int active;      // workers still in this loop
+#endif
+} job_pool_t;
+
+#ifdef JOB_POOL_THREADED
+static inline uint64_t job_pool_range(uint32_t begin, uint32_t end) {
+    return (uint64_t)begin | ((uint64_t)end << 32);
+}
+
+// take the next batch from the front of a thread's own range (or -1)
+static int job_pool_pop(job_pool_t* pool, int self) {
+    uint64_t range = atomic_load(&pool->ranges[self]);
+    for (;;) {
+        uint32_t begin = (uint32_t)range;
+        uint32_t end = (uint32_t)(range >> 32);
+        if (begin >= end) {
+            return -1;
+        }
+        if (atomic_compare_exchange_weak(&pool->ranges[self], &range, job_pool_range(begin + 1, end))) {
+            return (int)begin;
+        }
+    }
+}
+
+// take the back half of another thread's range, keep all but the first batch of it & return that (or -1)
+static int job_pool_steal(job_pool_t* pool, int self) {
+    for (int i = 1; i < pool->thread_count; i++) {
+        int victim = (self + i) % pool->thread_count;
+        uint64_t range = atomic_load(&pool->ranges[victim]);
+        uint32_t begin = (uint32_t)range;
+        uint32_t end = (uint32_t)(range >> 32);
+        if (begin >= end) {
+            continue;
+        }
+        uint32_t split = end - (end - begin + 1) / 2;
+        if (atomic_compare_exchange_strong(&pool->ranges[victim], &range, job_pool_range(begin, split))) {
+            // own range is empty, so nobody else is changing it
+            atomic_store(&pool->ranges[self], job_pool_range(split + 1, end));
+            return (int)split;
+        }
+    }
+    return -1;
+}
+
+// run batches until there are none left anywhere
+static void job_pool_work(job_pool_t* pool, int self) {
+    while (atomic_load(&pool->pending) > 0) {
+        int batch = job_pool_pop(pool, self);
+        if (batch == -1) {
+            batch = job_pool_steal(pool, self);
+        }
+        if (batch == -1) {
+            // the last few batches are running on other threads
+            sched_yield();
+            continue;
+        }
+        int begin = batch * pool->batch;
+        pool->fn(pool->userdata, begin, MIN(begin + pool->batch, pool->count));
+        atomic_fetch_sub(&pool->pending, 1);
+    }
+}
+
+static void* job_pool_worker(void* userdata) {
+    job_pool_worker_t* worker = (job_pool_worker_t*)userdata;
+    job_pool_t* pool = worker->pool;
+    pthread_mutex_lock(&pool->lock);
+
+    // starts at 0 (not the current generation), so a worker that starts late still joins the first loop
+    uint32_t seen = 0;
+    while (pool->running) {
+        if (pool->generation == seen) {
+            pthread_cond_wait(&pool->wake, &pool->lock);
+            continue;
+        }
+        seen = pool->generation;
+        pthread_mutex_unlock(&pool->lock);
+        job_pool_work(pool, worker->index);
+        atomic_fetch_sub(&pool->active, 1);
+        pthread_mutex_lock(&pool->lock);
+    }
+    pthread_mutex_unlock(&pool->lock);
+    return NULL;
+}
+#endif
+
+// start a pool with threads threads (including the calling one), 0 for one per core
+void job_pool_init(job_pool_t* pool, int threads) {
+    memset(pool, 0, sizeof(job_pool_t));
+    pool->thread_count = 1;
+#ifdef JOB_POOL_THREADED
+    if (threads <= 0) {
+        threads = (int)sysconf(_SC_NPROCESSORS_ONLN);
+    }
+    threads = MAX(MIN(threads, JOB_POOL_MAX_THREADS), 1);
+    pthread_mutex_init(&pool->lock, NULL);
+    pthread_cond_init(&pool->wake, NULL);
+    pool->running = true;
+    for (int i = 1; i < threads; i++) {
+        pool->workers[i].pool = pool;
+        pool->workers[i].index = i;
+        if (pthread_create(&pool->threads[i], NULL, job_pool_worker, &pool->workers[i]) != 0) {
+            pntr_app_log(PNTR_APP_LOG_WARNING, "Jobs: could not start all workers.");
+            break;
+        }
+        pool->thread_count++;
+    }
+#endif
+}
+
+// stop workers
+void job_pool_unload(job_pool_t* pool) {
+#ifdef JOB_POOL_THREADED
+    pthread_mutex_lock(&pool->lock);
+    pool->running = false;
+    pthread_cond_broadcast(&pool->wake);
+    pthread_mutex_unlock(&pool->lock);
+    for (int i = 1; i < pool->thread_count; i++) {
+        pthread_join(pool->threads[i], NULL);
+    }
+    pthread_cond_destroy(&pool->wake);
+    pthread_mutex_destroy(&pool->lock);
+#endif
+    memset(pool, 0, sizeof(job_pool_t));
+}
+
+// run fn over [0, count) in batches of batch items, spread over the pool, and wait for all of it
+// small loops (2 batches or less) just run on the calling thread
+void job_pool_for(job_pool_t* pool, int count, int batch, JobPoolFn fn, void* userdata) {
+    if (count <= 0 || fn == NULL) {
+        return;
+    }
+    batch = MAX(batch, 1);
+    int batches = (count + batch - 1) / batch;
+    if (pool == NULL || pool->thread_count <= 1 || batches <= 2) {
+        fn(userdata, 0, count);
+        return;
+    }
+
+#ifdef JOB_POOL_THREADED
+    pool->fn = fn;
+    pool->userdata = userdata;
+    pool->count = count;
+    pool->batch = batch;
+    for (int t = 0; t < pool->thread_count; t++) {
+        uint32_t begin = (uint32_t)((int64_t)batches * t / pool->thread_count);
+        uint32_t end = (uint32_t)((int64_t)batches * (t + 1) / pool->thread_count);
+        atomic_store(&pool->ranges[t], job_pool_range(begin, end));
+    }
+    atomic_store(&pool->pending, batches);
+    atomic_store(&pool->active, pool->thread_count - 1);
+
+    pthread_mutex_lock(&pool->lock);
+    pool->generation++;
+    pthread_cond_broadcast(&pool->wake);
+    pthread_mutex_unlock(&pool->lock);
+
+    job_pool_work(pool, 0);
+
+    // workers could still be looking at ranges, so don't let the next loop reset them yet
+    while (atomic_load(&pool->active) > 0) {
+        sched_yield();
+    }
+#endif
+}
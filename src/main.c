@@ -1,4 +1,7 @@
+// tools/headless.c includes this file & provides its own (windowless) pntr_app
+#ifndef LOP_HEADLESS
 #define PNTR_APP_IMPLEMENTATION
+#endif
 #define PNTR_APP_SFX_IMPLEMENTATION
 #define PNTR_TILED_IMPLEMENTATION
 
@@ -6,25 +9,111 @@
 #define PNTR_ENABLE_DEFAULT_FONT
 // #define DEBUG
 
+// frame-profiler (F2 shows graph, F3 writes trace.json), on in DEBUG
+// #define PROFILER
+#if defined(DEBUG) && !defined(PROFILER)
+#define PROFILER
+#endif
+
 #include "pntr_app.h"
-#include "pntr_tiled.h"
 
-#include "adventure.h"
+// every object's random-stream is seeded from this & its map (see adventure_random.h), recordings keep it
+static uint64_t random_seed = 0;
+#ifndef ADVENTURE_RANDOM_SEED
+#define ADVENTURE_RANDOM_SEED random_seed
+#endif
 
-// I'm really into linked-lists right now
-#include "ll_sound.h"
-#include "ll_animation_queue.h"
+#include "pntr_tiled.h"
+
+#include "profiler.h"
 
-// head of linked list
-static adventure_map_t* maps = NULL;
-static sound_holder_t* sounds = NULL;
-static animation_queue_t* animations = NULL;
+#include "adventure.h"
+#include "sound_cache.h"
+#include "sound_mixer.h"
+#include "text_cache.h"
+#include "command_queue.h"
+#include "adventure_contacts.h"
+#include "adventure_prefetch.h"
+#include "job_pool.h"
+#include "input_record.h"
+
+// loaded maps & sounds
+static asset_cache_t maps;
+static asset_cache_t sounds;
+
+// how much memory maps/sounds can use, before least-recently-used ones are unloaded
+static size_t map_budget = 16 * 1024 * 1024;
+static size_t sound_budget = 4 * 1024 * 1024;
+
+// handles for things we use a lot (so we don't have to look them up every frame)
+static asset_handle_t titleMapHandle;
+static asset_handle_t deadMapHandle;
+static asset_handle_t dialogMapHandle;
+static asset_handle_t startMapHandle;
+static asset_handle_t hurtSoundHandle;
+
+// timed things (animations, etc)
+static command_queue_t commands;
+
+// what the player is touching (handlers for each type of object are set in Init)
+static adventure_contacts_t contacts;
+
+// per-frame scratch memory, reset at the start of each frame
+static arena_t scratch;
 
 // default font for dialogs
 static pntr_font* font;
 
-// current-loaded game map
+// font in an atlas, & laid-out text (title, death-screen, dialogs)
+static text_cache_t texts;
+static asset_handle_t titleTextHandle = 0;
+static asset_handle_t deadTextHandle = 0;
+
+// the HUD's gem-counter, only laid out again when gemCount changes
+static text_layout_t hudLayout = {0};
+static int hudGems = 0;
+
+// loads portal-destinations in the background
+static adventure_prefetch_t prefetch;
+
+// synthesizes (or loads saved samples for) the sounds on the current map in the background
+static adventure_prefetch_t sound_prefetch;
+
+// plays sounds from a fixed pool of voices, all at once after the frame's ticks (hurt can only start every 0.25s)
+static sound_mixer_t mixer;
+
+// NPC intents are worked out on these threads (0 = one per core)
+static job_pool_t jobs;
+static int job_threads = 0;
+
+// where an NPC wants to go this tick: worked out in parallel, then moves are applied in entity-order
+typedef struct npc_intent_t {
+    bool moved;
+    float x;
+    float y;
+} npc_intent_t;
+
+// 1 per entity, in scratch (only needed during a tick)
+static npc_intent_t* npc_intents = NULL;
+
+// length of the current tick, for NPC jobs
+static float npc_dt = 0;
+
+// current-loaded game map (held in cache, so it's not evicted)
 static adventure_map_t* currentMap = NULL;
+static asset_handle_t currentMapHandle = 0;
+
+// maps you've been to: when one is evicted from the cache, what changed on it (loot, chests, NPCs) is saved here,
+// & put back when you go there again, so leaving a room for long enough doesn't reset it
+typedef struct map_save_t {
+    asset_handle_t handle;
+    bool saved;                     // snapshot holds its state (it was evicted, & you haven't been back)
+    adventure_snapshot_t snapshot;
+    arena_t arena;                  // snapshot lives in this
+} map_save_t;
+static map_save_t* map_saves = NULL;
+static int map_save_count = 0;
+static int map_save_capacity = 0;
 
 // eventually, I could get these from the map somehow
 static float player_speed = 200;
@@ -48,218 +137,562 @@ static bool showTitle = true;
 // your roopies
 static int gemCount = 0;
 
+// simulation runs at a fixed rate (try 120 for smoother movement, or 30 on slow handhelds), drawing runs at whatever the display does
+static float tick_rate = 60;
+
+// longest frame we will catch up on (so a stall doesn't turn into a burst of ticks)
+static float tick_max_frame = 0.25f;
+
+// time not simulated yet
+static float tick_accumulator = 0;
+
+// how far (in tiles, walking around walls) NPCs can notice the player from
+static int npc_awareness_max = 10;
+
+// range of NPC speeds, in pixels per second (each one picks its own, once)
+static float npc_speed_min = 15;
+static float npc_speed_max = 60;
+
+// set this to true to put rooms back how they were (loot, chests, NPCs) every time you walk into them
+static bool reset_rooms = false;
+
+// map to start on (can be set on command-line, like ./build/lop build/bench/stress.tmj)
+static char* startMap = "assets/main.tmj";
+
+// buttons held this frame (INPUT_UP, etc), read once per frame so they can be recorded or replayed
+static uint8_t input_buttons = 0;
+
+// --record FILE saves a session, --replay FILE plays one back
+static input_record_t recording;
+static char* record_file = NULL;
+static char* replay_file = NULL;
+
+// read keys & gamepad into buttons
+static uint8_t read_buttons(pntr_app* app) {
+    uint8_t buttons = 0;
+    if (pntr_app_key_down(app, PNTR_APP_KEY_UP) || pntr_app_gamepad_button_down(app, 0, PNTR_APP_GAMEPAD_BUTTON_UP)) {
+        buttons |= INPUT_UP;
+    }
+    if (pntr_app_key_down(app, PNTR_APP_KEY_DOWN) || pntr_app_gamepad_button_down(app, 0, PNTR_APP_GAMEPAD_BUTTON_DOWN)) {
+        buttons |= INPUT_DOWN;
+    }
+    if (pntr_app_key_down(app, PNTR_APP_KEY_LEFT) || pntr_app_gamepad_button_down(app, 0, PNTR_APP_GAMEPAD_BUTTON_LEFT)) {
+        buttons |= INPUT_LEFT;
+    }
+    if (pntr_app_key_down(app, PNTR_APP_KEY_RIGHT) || pntr_app_gamepad_button_down(app, 0, PNTR_APP_GAMEPAD_BUTTON_RIGHT)) {
+        buttons |= INPUT_RIGHT;
+    }
+    if (pntr_app_key_down(app, PNTR_APP_KEY_SPACE)) {
+        buttons |= INPUT_ACTION;
+    }
+    return buttons;
+}
+
+static inline bool input_down(uint8_t button) {
+    return (input_buttons & button) != 0;
+}
+
 // we can derive the correct tile (specific to my spritesheet layout)
 // since each row (12 tiles) is a character, broken into 3 frames per direction
 // with the 2nd frame as the indicator for "walking animation"
 // this will work with my spritesheet, but you can adjust for yours, if it's differnt
-static void set_gid(cute_tiled_object_t* character, int gid_direction, int gid_walking) {
-    int gid_character = character->gid/12;
-    character->gid = (gid_character*12) + 1 + gid_walking + (gid_direction*3);
+static void set_gid(adventure_entities_t* entities, int character, int gid_direction, int gid_walking) {
+    int gid_character = entities->gid[character]/12;
+    entities->gid[character] = (gid_character*12) + 1 + gid_walking + (gid_direction*3);
 }
 
-// move in opposite direction currently facing, if not colliding
-static void bump_back(cute_tiled_object_t* character, float player_speed, cute_tiled_map_t* map, cute_tiled_layer_t* collision_layer, const pntr_rectangle* player_rect) {;
+// move in opposite direction currently facing, up to a wall
+static void bump_back(int character, float player_speed, adventure_map_t* mapContainer, const pntr_rectangle* player_rect) {;
     // Direction deltas: S, N, E, W
     const int dx[4] = { 0,  0,  -1, 1 };
     const int dy[4] = { -1, 1,  0,  0 };
 
-    pntr_rectangle new_rect = *player_rect;
+    adventure_entities_t* entities = &mapContainer->entities;
+    float move_x = dx[entities->gid[character] % 4] * player_speed;
+    float move_y = dy[entities->gid[character] % 4] * player_speed;
 
-    // Calculate intended new position
-    new_rect.x = character->x + dx[character->gid % 4] * player_speed;
-    new_rect.y = character->y + dy[character->gid % 4] * player_speed;
+    // as far as it can go, up to a wall
+    adventure_sweep_t sweep;
+    adventure_sweep_entity(mapContainer, character, player_rect, move_x, move_y, &sweep);
+    adventure_move_object_to(mapContainer, character, sweep.x, sweep.y);
+}
+
+// get handle for an rfx sound by name (from assets/rfx/)
+static asset_handle_t sfx_handle(const char* name) {
+    char sound[PNTR_PATH_MAX] = {0};
+    PNTR_STRCAT(sound, "assets/rfx/");
+    PNTR_STRCAT(sound, name);
+    PNTR_STRCAT(sound, ".rfx");
+    return asset_cache_intern(&sounds, sound);
+}
 
-    // Only move if no collision
-    if (!adventure_check_static_collision(map, collision_layer, &new_rect)) {
-        character->x = new_rect.x;
-        character->y = new_rect.y;
+// handle for the sound something makes (resolved the first time)
+static asset_handle_t props_sound_handle(adventure_props_t* props) {
+    if (props->sound_handle == 0 && props->sound != NULL) {
+        props->sound_handle = sfx_handle(props->sound);
     }
+    return props->sound_handle;
 }
 
+// play a sound (it starts in sound_mixer_submit), if it's still being made in the background that's waited for (instead of making it again)
+static void sfx_play(asset_handle_t handle) {
+    adventure_prefetch_wait(&sound_prefetch, handle);
+    sound_mixer_play(&mixer, handle);
+}
 
-// this is called when the player or an NPC touches something
-// object will be NULL, if it's static geometry (from collision layer)
-void CollisionCallback(pntr_app* app, adventure_map_t* mapContainer, cute_tiled_object_t* subject, cute_tiled_object_t* object) {
-    if (gemCount < 0) {
-        // nothing happens when you're dead
-        return;
+// get handle for the map a portal links to (portal name is the map)
+static asset_handle_t portal_handle(adventure_props_t* props) {
+    if (props->target_handle == 0 && props->name != NULL) {
+        char filename[PNTR_PATH_MAX] = {0};
+        PNTR_STRCAT(filename, "assets/");
+        PNTR_STRCAT(filename, props->name);
+        PNTR_STRCAT(filename, ".tmj");
+        props->target_handle = asset_cache_intern(&maps, filename);
     }
-    if (object == NULL) {
-        pntr_app_log_ex(PNTR_APP_LOG_DEBUG,"Map: %s bumped static\n", subject->name.ptr);
-    } else {
-        // action only happens when it's the player
-        if (PNTR_STRCMP(subject->name.ptr, "player") != 0) {
-            return;
-        }
-
-        // get all properties from object
-        char sound[PNTR_PATH_MAX] = {0};
-        int value = 1;
+    return props->target_handle;
+}
 
-        int pos_x = 0;
-        int pos_y = 0;
-        bool setpos = false;
+// find the save for a map (NULL if you have not been there)
+static map_save_t* map_save_find(asset_handle_t handle) {
+    for (int i = 0; handle != 0 && i < map_save_count; i++) {
+        if (map_saves[i].handle == handle) {
+            return &map_saves[i];
+        }
+    }
+    return NULL;
+}
 
-        for (int i = 0; i < object->property_count; i++) {
-            cute_tiled_property_t* prop = &object->properties[i];
+// you are on a map: remember it (so it's saved if it's evicted), & if it was, put it back how you left it
+static void map_save_visit(asset_handle_t handle, adventure_map_t* map) {
+    map_save_t* save = map_save_find(handle);
+    if (save == NULL) {
+        if (map_save_count == map_save_capacity) {
+            int capacity = map_save_capacity ? map_save_capacity * 2 : 16;
+            map_save_t* saves = pntr_load_memory(sizeof(map_save_t) * capacity);
+            memset(saves, 0, sizeof(map_save_t) * capacity);
+            if (map_saves != NULL) {
+                memcpy(saves, map_saves, sizeof(map_save_t) * map_save_count);
+                pntr_unload_memory(map_saves);
+            }
+            map_saves = saves;
+            map_save_capacity = capacity;
+        }
+        save = &map_saves[map_save_count++];
+        save->handle = handle;
+        arena_init(&save->arena, 0);
+    }
+    if (save->saved && map != NULL) {
+        adventure_snapshot_restore(map, &save->snapshot);
+    }
+    save->saved = false;
+    arena_reset(&save->arena);
+}
 
-            if (prop->type == CUTE_TILED_PROPERTY_STRING) {
-                if (PNTR_STRCMP("text", prop->name.ptr) == 0) {
-                    dialogText[0] = 0;
-                    PNTR_STRCAT(dialogText, prop->data.string.ptr);
-                    shownDialog = false;
-                }
+// forget every save (after a restart, maps come back how they were baked)
+static void map_save_clear(void) {
+    for (int i = 0; i < map_save_count; i++) {
+        arena_unload(&map_saves[i].arena);
+    }
+    if (map_saves != NULL) {
+        pntr_unload_memory(map_saves);
+    }
+    map_saves = NULL;
+    map_save_count = 0;
+    map_save_capacity = 0;
+}
 
-                if (PNTR_STRCMP("name", prop->name.ptr) == 0) {
-                    PNTR_STRCAT(dialogName, prop->data.string.ptr);
-                }
-                
-                else if (PNTR_STRCMP("sound", prop->name.ptr) == 0) {
-                    PNTR_STRCAT(sound, "assets/rfx/");
-                    PNTR_STRCAT(sound, prop->data.string.ptr);
-                    PNTR_STRCAT(sound, ".rfx");
-                }
-                else if (PNTR_STRCMP("facing", prop->name.ptr) == 0) {
-                    // TODO: use this to set directiopn of player on portal
-                }
+// switch current map, and hold it in cache
+static void set_current_map(asset_handle_t handle) {
+    adventure_prefetch_wait(&prefetch, handle);
+    adventure_map_t* map = asset_cache_acquire(&maps, handle);
+    if (map != NULL) {
+        map_save_visit(handle, map);
+    }
+    // the map you left doesn't need its chunk-images until you're back
+    // (before it's released, that can unload it)
+    if (currentMap != map) {
+        adventure_chunks_trim(currentMap);
+    }
+    if (currentMapHandle != 0) {
+        asset_cache_release(&maps, currentMapHandle);
+    }
+    currentMap = map;
+    currentMapHandle = handle;
+    adventure_contacts_clear(&contacts);
+
+    // start loading everywhere you can go from here
+    if (currentMap != NULL) {
+        // don't interpolate from wherever things were the last time we were here
+        adventure_entities_snapshot(&currentMap->entities);
+
+        // & get every sound on it ready, so touching something doesn't stall on synthesizing
+        adventure_entities_t* entities = &currentMap->entities;
+        for (int e = 0; e < entities->count; e++) {
+            if (entities->type[e] == ADVENTURE_TYPE_PORTAL) {
+                adventure_prefetch_request(&prefetch, portal_handle(&entities->props[e]));
             }
-            else if (prop->type == CUTE_TILED_PROPERTY_INT) {
-                if (PNTR_STRCMP("pos_x", prop->name.ptr) == 0) {
-                    pos_x = prop->data.integer;
-                    setpos = true;
-                }
-                else if (PNTR_STRCMP("pos_y", prop->name.ptr) == 0) {
-                    pos_y = prop->data.integer;
-                    setpos = true;
-                }
-                else if (PNTR_STRCMP("value", prop->name.ptr) == 0) {
-                    value = prop->data.integer;
-                }
+            if (entities->props[e].sound != NULL) {
+                adventure_prefetch_request(&sound_prefetch, props_sound_handle(&entities->props[e]));
             }
         }
+    }
+}
 
-        // Now we use all the props
+// cancel anything scheduled for a map, & save it if you've been there, before it's unloaded
+// (if it was loaded again but you haven't been back, the save from last time is still what it should be)
+static void MapUnload(void* map, void* userdata) {
+    // chunk-images first, without telling the cache (it's in the middle of unloading this)
+    adventure_chunks_unload((adventure_map_t*)map);
+    command_cancel_entity(&commands, (adventure_map_t*)map, -1);
+    map_save_t* save = map_save_find(asset_cache_find(&maps, map));
+    if (save != NULL && !save->saved) {
+        save->saved = adventure_snapshot_take((adventure_map_t*)map, &save->snapshot, &save->arena);
+    }
+    adventure_cache_unload(map, userdata);
+}
 
-        // anything can have a sound prop
-        if (sound[0] != 0) {
-            sound_holder_t* s = sfx_load(&sounds, app, sound);
-            if (s != NULL && s->sound != NULL) {
-                pntr_play_sound(s->sound, false);
-            }
+// put a map back how it was when it loaded (& drop anything scheduled for it)
+static void reset_map(adventure_map_t* map) {
+    command_cancel_entity(&commands, map, -1);
+    adventure_map_reset(map);
+}
+
+
+// this is called when the player bumps into a wall
+void CollisionCallback(pntr_app* app, adventure_map_t* mapContainer, int subject, int object) {
+    pntr_app_log_ex(PNTR_APP_LOG_DEBUG,"Map: %d bumped static\n", mapContainer->entities.id[subject]);
+}
+
+// the player started touching something: show its text & play its sound (anything can have those)
+// returns false if nothing should happen (you're dead)
+static bool contact_start(adventure_props_t* props) {
+    if (gemCount < 0) {
+        return false;
+    }
+    if (props->text != NULL) {
+        dialogText[0] = 0;
+        PNTR_STRCAT(dialogText, props->text);
+        shownDialog = false;
+    }
+    if (props->speaker != NULL) {
+        PNTR_STRCAT(dialogName, props->speaker);
+    }
+    if (props->sound != NULL) {
+        sfx_play(props_sound_handle(props));
+    }
+    return true;
+}
+
+// signs, musings & anything else with no behaviour of its own
+static void ContactOther(pntr_app* app, adventure_map_t* map, int subject, int object, adventure_props_t* props, adventure_contact_event_t event) {
+    contact_start(props);
+}
+
+static void ContactPortal(pntr_app* app, adventure_map_t* map, int subject, int object, adventure_props_t* props, adventure_contact_event_t event) {
+    if (!contact_start(props)) {
+        return;
+    }
+    // usually already prefetched, so this just swaps it in (and clears contacts, so nothing else on the old map fires)
+    set_current_map(portal_handle(props));
+    if (reset_rooms && currentMap != NULL) {
+        reset_map(currentMap);
+    }
+    if (props->setpos && currentMap != NULL && currentMap->entities.player != -1) {
+        int player = currentMap->entities.player;
+        currentMap->entities.x[player] = props->pos_x;
+        currentMap->entities.y[player] = props->pos_y;
+        currentMap->entities.prev_x[player] = props->pos_x;
+        currentMap->entities.prev_y[player] = props->pos_y;
+        adventure_grid_update(&currentMap->grid, &currentMap->entities, player);
+    }
+}
+
+static void ContactLoot(pntr_app* app, adventure_map_t* map, int subject, int object, adventure_props_t* props, adventure_contact_event_t event) {
+    if (!contact_start(props)) {
+        return;
+    }
+    map->entities.visible[object] = false;
+    gemCount += props->value;
+}
+
+static void ContactChest(pntr_app* app, adventure_map_t* map, int subject, int object, adventure_props_t* props, adventure_contact_event_t event) {
+    if (!contact_start(props)) {
+        return;
+    }
+    adventure_entities_t* entities = &map->entities;
+    if (entities->gid[object] != 102 && entities->gid[object] != 104) {
+        gemCount += props->value;
+        entities->gid[object] = 102;
+        command_set_gid(&commands, map, object, 104, 0.2f);
+    }
+}
+
+// traps have 3 frames, with animation in middle
+// this will animate, wait 0.4s, then  go back to "default state"
+static void ContactTrap(pntr_app* app, adventure_map_t* map, int subject, int object, adventure_props_t* props, adventure_contact_event_t event) {
+    if (!contact_start(props)) {
+        return;
+    }
+    adventure_entities_t* entities = &map->entities;
+    set_gid(entities, object, 0, 1);
+    gemCount -= props->value;
+    bump_back(subject, 4, map, &player_hitbox);
+    command_set_gid(&commands, map, object, entities->gid[object] - 1, 0.4f);
+    sfx_play(hurtSoundHandle);
+}
+
+static void ContactEnemy(pntr_app* app, adventure_map_t* map, int subject, int object, adventure_props_t* props, adventure_contact_event_t event) {
+    if (!contact_start(props)) {
+        return;
+    }
+    gemCount -= props->value;
+    // there can be weird collision bugs with moving thing bumping you wherever
+    bump_back(subject, 4, map, &player_hitbox);
+    sfx_play(hurtSoundHandle);
+}
+
+// work out where NPCs [begin, end) want to go (only reads the map & writes their own random-stream, so it runs on any thread)
+static void npc_intent_job(void* userdata, int begin, int end) {
+    ADVENTURE_ZONE_BEGIN(INTENTS);
+    adventure_map_t* map = (adventure_map_t*)userdata;
+    adventure_entities_t* entities = &map->entities;
+    int player = entities->player;
+    for (int e = begin; e < end; e++) {
+        npc_intents[e].moved = false;
+        if (e == player || entities->behaviour[e] == ADVENTURE_BEHAVIOUR_NONE) {
+            continue;
         }
+        adventure_random_t* random = &entities->random[e];
 
-        if (PNTR_STRCMP(object->type.ptr, "portal") == 0) {
-            // portal name is the map it links to
-            char filename[PNTR_PATH_MAX] = {0};
-            PNTR_STRCAT(filename, "assets/");
-            PNTR_STRCAT(filename, object->name.ptr);
-            PNTR_STRCAT(filename, ".tmj");
-            currentMap = adventure_load(filename, &maps);
-            if (setpos && currentMap != NULL && currentMap->player != NULL) {
-                currentMap->player->x = pos_y;
-                currentMap->player->y = pos_y;
-            }
+        // how fast & how far-sighted an NPC is, is picked the first time it moves
+        if (entities->awareness[e] == 0) {
+            entities->awareness[e] = adventure_random_int(random, 1, npc_awareness_max);
+            entities->speed[e] = adventure_random_float(random, npc_speed_min, npc_speed_max);
         }
-        else if (PNTR_STRCMP(object->type.ptr, "loot") == 0) {
-            object->visible = false;
-            gemCount += value;
+
+        npc_intent_t* intent = &npc_intents[e];
+        float speed = entities->speed[e] * npc_dt;
+        float target_x = entities->x[player] + adventure_random_int(random, 0, 1);
+        float target_y = entities->y[player] + adventure_random_int(random, 0, 1);
+        float x = entities->x[e];
+        float y = entities->y[e];
+        if (entities->behaviour[e] & ADVENTURE_BEHAVIOUR_FOLLOW) {
+            adventure_object_intent_on_field(map, e, target_x, target_y, speed, 1, entities->awareness[e], &x, &y);
         }
-        
-        else if (PNTR_STRCMP(object->type.ptr, "chest") == 0) {
-            if (object->gid != 102 && object->gid != 104) {
-                gemCount += value;
-                object->gid = 102;
-                animation_queue_add(&animations, object, 104, 0.2f, NULL);
-            }
+        // an object can be both, then it avoids from where following got it
+        if (entities->behaviour[e] & ADVENTURE_BEHAVIOUR_AVOID) {
+            adventure_object_intent_on_field(map, e, target_x, target_y, speed, 0, entities->awareness[e], &x, &y);
         }
+        intent->x = x;
+        intent->y = y;
+        intent->moved = x != entities->x[e] || y != entities->y[e];
+    }
+    ADVENTURE_ZONE_END(INTENTS);
+}
 
-        // traps have 3 frames, with animation in middle
-        // this will animate, wait 0.4s, then  go back to "default state"
-        else if (PNTR_STRCMP(object->type.ptr, "trap") == 0) {
-            set_gid(object, 0, 1);
-            gemCount -= value;
-            bump_back(subject, 4, currentMap->map, currentMap->layer_collisions, &player_hitbox);
-
-            animation_queue_add(&animations, object, object->gid - 1, 0.4f, NULL);
-            sound_holder_t* s = sfx_load(&sounds, app, "assets/rfx/hurt.rfx");
-            if (s != NULL && s->sound != NULL) {
-                pntr_play_sound(s->sound, false);
-            }
+// a single fixed-length simulation step: input, player, NPCs & timed things
+static void Tick(pntr_app* app, float dt) {
+    ADVENTURE_ZONE_BEGIN(SIM);
+
+    // objects are drawn between where they were at the start of the tick & where they end up
+    adventure_entities_snapshot(&currentMap->entities);
+
+    ADVENTURE_ZONE_BEGIN(COMMANDS);
+    command_queue_run(&commands, dt);
+    ADVENTURE_ZONE_END(COMMANDS);
+
+    float move_x = 0;
+    float move_y = 0;
+
+    adventure_entities_t* entities = &currentMap->entities;
+    int player = entities->player;
+
+    if (player != -1){
+        int gid_walking = 0;
+
+        if (input_down(INPUT_DOWN)) {
+            move_y += player_speed * dt;
+            gid_direction = 0;
+            gid_walking = 1;
+        }
+        else if (input_down(INPUT_UP)) {
+            move_y -= player_speed * dt;
+            gid_direction = 1;
+            gid_walking = 1;
         }
-        else if (PNTR_STRCMP(object->type.ptr, "enemy") == 0) {
-            gemCount -= value;
-            // there can be weird collision bugs with moving thing bumping you wherever
-            bump_back(subject, 4, currentMap->map, currentMap->layer_collisions, &player_hitbox);
-            sound_holder_t* s = sfx_load(&sounds, app, "assets/rfx/hurt.rfx");
-            if (s != NULL && s->sound != NULL) {
-                pntr_play_sound(s->sound, false);
+        else if (input_down(INPUT_RIGHT)) {
+            move_x += player_speed * dt;
+            gid_direction = 2;
+            gid_walking = 1;
+        }
+        else if (input_down(INPUT_LEFT)) {
+            move_x -= player_speed * dt;
+            gid_direction = 3;
+            gid_walking = 1;
+        }
+
+        set_gid(entities, player, gid_direction, gid_walking);
+
+        // this requests the new position (walls stop it, touching objects is handled after NPCs move)
+        adventure_try_to_move_player(app, currentMap, move_x, move_y, &player_hitbox, &CollisionCallback);
+    }
+
+    // update all objects that are not player
+    if (player != -1) {
+        ADVENTURE_ZONE_BEGIN(NPC);
+        // one flow-field (to the player's tile) for every follower/avoider, only rebuilt when the player changes tile
+        int player_tile_x = (int)floorf((entities->x[player] + entities->width[player] / 2) / MAX(currentMap->header->tilewidth, 1));
+        int player_tile_y = (int)floorf((entities->y[player] + entities->height[player] / 2) / MAX(currentMap->header->tileheight, 1));
+        adventure_nav_update(&currentMap->nav, &currentMap->collision, player_tile_x, player_tile_y, npc_awareness_max);
+
+        arena_mark_t mark = arena_mark(&scratch);
+        npc_intents = arena_alloc(&scratch, sizeof(npc_intent_t) * MAX(entities->count, 1));
+
+        npc_dt = dt;
+        job_pool_for(&jobs, entities->count, 256, npc_intent_job, currentMap);
+
+        for (int e = 0; e < entities->count; e++) {
+            if (npc_intents[e].moved) {
+                adventure_move_object_to(currentMap, e, npc_intents[e].x, npc_intents[e].y);
             }
         }
-        
+        npc_intents = NULL;
+        arena_rewind(&scratch, mark);
+        ADVENTURE_ZONE_END(NPC);
     }
+
+    // things the player started (or stopped) touching, after everything has moved
+    adventure_contacts_update(&contacts, app, currentMap, currentMap->entities.player, &player_hitbox);
+
+    ADVENTURE_ZONE_END(SIM);
 }
 
 bool Init(pntr_app* app) {
+#ifdef PROFILER
+    profiler_init();
+#endif
     font = pntr_load_font_default();
-    
+    text_cache_init(&texts, font, PNTR_RAYWHITE);
+    titleTextHandle = text_cache_intern(&texts, "the legend\n of pntr", 0);
+    deadTextHandle = text_cache_intern(&texts, "You died, penniless.\n\nSomeone will be along to attend your grave, forthwith.", 280);
+    command_queue_init(&commands, 64);
+    arena_init(&scratch, 64 * 1024);
+
+    adventure_contacts_init(&contacts);
+    for (int type = 0; type < ADVENTURE_TYPE_COUNT; type++) {
+        adventure_contacts_on(&contacts, (adventure_type_t)type, ContactOther, ADVENTURE_CONTACT_ENTER);
+    }
+    adventure_contacts_on(&contacts, ADVENTURE_TYPE_PORTAL, ContactPortal, ADVENTURE_CONTACT_ENTER);
+    adventure_contacts_on(&contacts, ADVENTURE_TYPE_LOOT, ContactLoot, ADVENTURE_CONTACT_ENTER);
+    adventure_contacts_on(&contacts, ADVENTURE_TYPE_CHEST, ContactChest, ADVENTURE_CONTACT_ENTER);
+    adventure_contacts_on(&contacts, ADVENTURE_TYPE_TRAP, ContactTrap, ADVENTURE_CONTACT_ENTER);
+    adventure_contacts_on(&contacts, ADVENTURE_TYPE_ENEMY, ContactEnemy, ADVENTURE_CONTACT_ENTER);
+
+    asset_cache_init(&maps, 16, map_budget, adventure_cache_load, MapUnload, &maps);
+    sound_cache_init(&sounds, app, sound_budget);
+    adventure_prefetch_init(&prefetch, &maps);
+    adventure_prefetch_init(&sound_prefetch, &sounds);
+    sound_mixer_init(&mixer, &sounds);
+    commands.mixer = &mixer;
+    job_pool_init(&jobs, job_threads);
+
+    // a replay sets up seed, tick-rate & map to what they were when it was recorded
+    if (replay_file != NULL && input_record_replay(&recording, replay_file)) {
+        random_seed = recording.seed;
+        tick_rate = recording.tick_rate;
+        startMap = recording.map;
+    } else if (record_file != NULL) {
+        input_record_start(&recording, record_file, random_seed, tick_rate, startMap);
+    }
+
+    titleMapHandle = asset_cache_intern(&maps, "assets/title.tmj");
+    deadMapHandle = asset_cache_intern(&maps, "assets/dead.tmj");
+    dialogMapHandle = asset_cache_intern(&maps, "assets/dialog.tmj");
+    startMapHandle = asset_cache_intern(&maps, startMap);
+    hurtSoundHandle = sfx_handle("hurt");
+    adventure_prefetch_request(&sound_prefetch, hurtSoundHandle);
+    sound_mixer_set(&mixer, hurtSoundHandle, 1, 0.25f, 10);
+
     // you can prelaod any maps too, just set currentMap to the one you want
-    currentMap = adventure_load("assets/main.tmj", &maps);
+    set_current_map(startMapHandle);
     
     return true;
 }
 
 void Close(pntr_app* app) {
-    while(maps != NULL) {
-       adventure_unload(&maps);
-    }
-    while(animations != NULL) {
-       animation_queue_unload(&animations);
-    }
-    while(sounds != NULL) {
-       sounds_unload(&sounds);
-    }
+    adventure_prefetch_unload(&prefetch);
+    adventure_prefetch_unload(&sound_prefetch);
+    job_pool_unload(&jobs);
+    input_record_stop(&recording);
+    arena_unload(&scratch);
+    asset_cache_free(&maps);
+    map_save_clear();
+    sound_mixer_unload(&mixer);
+    asset_cache_free(&sounds);
+    command_queue_unload(&commands);
+    text_layout_unload(&hudLayout);
+    text_cache_free(&texts);
+    pntr_unload_font(font);
 }
 
 
 bool Update(pntr_app* app, pntr_image* screen) {
     float dt = pntr_app_delta_time(app);
+    arena_reset(&scratch);
+
+    // input & frame-length, from the player (maybe recorded) or a replay
+    uint8_t buttons = read_buttons(app);
+    input_record_frame(&recording, &buttons, &dt);
+    input_buttons = buttons;
+
+    // every map's tile-animations run on 1 clock
+    adventure_anim_update(dt);
+    sound_mixer_update(&mixer, dt);
+
+    // swap in anything that finished loading in background
+    adventure_prefetch_update(&prefetch);
+    adventure_prefetch_update(&sound_prefetch);
 
     // no roopies, you're dead!
     if (gemCount < 0) {
-        adventure_map_t* dialogMap = adventure_load("assets/dead.tmj", &maps);
+        adventure_map_t* dialogMap = adventure_get(deadMapHandle, &maps);
         
-        if (dialogMap != NULL && dialogMap->map != NULL) {
-            pntr_clear_background(screen, dialogMap->map->backgroundcolor ? pntr_tiled_color(dialogMap->map->backgroundcolor) : PNTR_BLACK);
-            pntr_update_tiled(dialogMap->map,  dt);
-            dialogMap->player->y -= dt * (player_speed/8);
-            pntr_draw_tiled(screen, dialogMap->map, 0, 0, PNTR_WHITE);
+        if (dialogMap != NULL) {
+            pntr_clear_background(screen, adventure_background(dialogMap));
+            if (dialogMap->entities.player != -1) {
+                dialogMap->entities.y[dialogMap->entities.player] -= dt * (player_speed/8);
+            }
+            adventure_draw(screen, dialogMap, 0, 0);
         }
 
 
-        pntr_draw_text_wrapped(screen, font, "You died, penniless.\n\nSomeone will be along to attend your grave, forthwith.", 20, 180, 280, PNTR_RAYWHITE);
+        text_cache_draw(screen, &texts, deadTextHandle, 20, 180);
 
         // restart on SPACE
-        if (pntr_app_key_down(app, PNTR_APP_KEY_SPACE)) {
+        if (input_down(INPUT_ACTION)) {
             gemCount = 0;
-            // unload all maps to reset state
-            while(maps != NULL) {
-                adventure_unload(&maps);
+            // put every loaded map back how it was, from the snapshot it took when it loaded (no reloading)
+            // & forget the ones that were evicted, so they load fresh
+            for (asset_handle_t handle = 1; handle <= (asset_handle_t)maps.count; handle++) {
+                if (asset_cache_loaded(&maps, handle)) {
+                    reset_map(adventure_get(handle, &maps));
+                }
             }
-            currentMap = adventure_load("assets/main.tmj", &maps);
+            map_save_clear();
+            set_current_map(startMapHandle);
         }
 
         return true;
     }
 
     if (showTitle) {
-        adventure_map_t* titleMap = adventure_load("assets/title.tmj", &maps);
-        pntr_update_tiled(titleMap->map,  dt);
-        pntr_clear_background(screen, titleMap->map->backgroundcolor ? pntr_tiled_color(titleMap->map->backgroundcolor) : PNTR_BLACK);
-        pntr_draw_tiled(screen, titleMap->map, 0, 0, PNTR_WHITE);
-        pntr_draw_text(screen, font, "the legend\n of pntr", 130, 100, PNTR_RAYWHITE);
+        adventure_map_t* titleMap = adventure_get(titleMapHandle, &maps);
+        pntr_clear_background(screen, adventure_background(titleMap));
+        adventure_draw(screen, titleMap, 0, 0);
+        text_cache_draw(screen, &texts, titleTextHandle, 130, 100);
 
         // start on SPACE
-        if (pntr_app_key_down(app, PNTR_APP_KEY_SPACE)) {
+        if (input_down(INPUT_ACTION)) {
             showTitle = false;
         }
 
@@ -271,15 +704,15 @@ bool Update(pntr_app* app, pntr_image* screen) {
         // 1-time render of dialog map
         if (!shownDialog) {
             shownDialog = true;
-            adventure_map_t* dialogMap = adventure_load("assets/dialog.tmj", &maps);
-            pntr_draw_tiled(screen, dialogMap->map, 0, 0, PNTR_WHITE);
-            pntr_draw_text_wrapped(screen, font, dialogText, 20, 180, 280, PNTR_RAYWHITE);
+            adventure_map_t* dialogMap = adventure_get(dialogMapHandle, &maps);
+            adventure_draw(screen, dialogMap, 0, 0);
+            text_cache_draw_text(screen, &texts, dialogText, 280, 20, 180);
             if (dialogName[0] != 0) {
-                pntr_draw_text_wrapped(screen, font, dialogName, 20, 160, 280, PNTR_RAYWHITE);
+                text_cache_draw_text(screen, &texts, dialogName, 280, 20, 160);
             }
         }
         // close on SPACE
-        if (pntr_app_key_down(app, PNTR_APP_KEY_SPACE)) {
+        if (input_down(INPUT_ACTION)) {
             dialogText[0] = 0;
             dialogName[0] = 0;
         }
@@ -287,83 +720,46 @@ bool Update(pntr_app* app, pntr_image* screen) {
     }
 
     else if (currentMap != NULL) {
-        animation_queue_run(&animations, dt);
-
-        pntr_vector req = {0};
-        pntr_vector camera = {0};
-
-        if (currentMap->player != NULL){
-            int gid_walking = 0;
-
-            if (pntr_app_key_down(app, PNTR_APP_KEY_DOWN) || pntr_app_gamepad_button_down(app, 0, PNTR_APP_GAMEPAD_BUTTON_DOWN)) {
-                req.y += player_speed * dt;
-                gid_direction = 0;
-                gid_walking = 1;
-            }
-            else if (pntr_app_key_down(app, PNTR_APP_KEY_UP) || pntr_app_gamepad_button_down(app, 0, PNTR_APP_GAMEPAD_BUTTON_UP)) {
-                req.y -= player_speed * dt;
-                gid_direction = 1;
-                gid_walking = 1;
-            }
-            else if (pntr_app_key_down(app, PNTR_APP_KEY_RIGHT) || pntr_app_gamepad_button_down(app, 0, PNTR_APP_GAMEPAD_BUTTON_RIGHT)) {
-                req.x += player_speed * dt;
-                gid_direction = 2;
-                gid_walking = 1;
-            }
-            else if (pntr_app_key_down(app, PNTR_APP_KEY_LEFT) || pntr_app_gamepad_button_down(app, 0, PNTR_APP_GAMEPAD_BUTTON_LEFT)) {
-                req.x -= player_speed * dt;
-                gid_direction = 3;
-                gid_walking = 1;
+        // run as many fixed ticks as real time has passed (a long frame can't make things skip through walls)
+        tick_accumulator += MIN(dt, tick_max_frame);
+        float step = 1.0f / tick_rate;
+        while (tick_accumulator >= step) {
+            Tick(app, step);
+            tick_accumulator -= step;
+
+            // something opened a dialog, or killed you, stop simulating until that's dealt with
+            if (dialogText[0] != 0 || gemCount < 0) {
+                tick_accumulator = 0;
+                break;
             }
+        }
 
-            set_gid(currentMap->player, gid_direction, gid_walking);
+        // sounds only start from ticks, play them together
+        sound_mixer_submit(&mixer);
 
-            // this requests the new position (but collisions or map bounds might deny)
-            adventure_try_to_move_player(app, currentMap, &req, &player_hitbox, &CollisionCallback);
-            adventure_camera_look_at(&camera, screen, currentMap->map, currentMap->player);
-        }
+        // draw objects part-way between the last 2 ticks, so movement is smooth at any frame-rate
+        currentMap->alpha = tick_accumulator / step;
 
-        // update all objects that are not player
-
-        int random_offset_x = 0;
-        int random_offset_y = 0;
-        float random_speed = 0;
-        int random_awareness = 0;
-
-        if (currentMap->layer_objects != NULL) {
-           for (cute_tiled_object_t* obj = currentMap->layer_objects->objects; obj; obj = obj->next) {
-                if (obj->id != currentMap->player->id) {
-                    for (int i = 0; i < obj->property_count; i++) {
-                        cute_tiled_property_t* prop = &obj->properties[i];
-                        if (prop->type == CUTE_TILED_PROPERTY_BOOL) {
-                            random_offset_x = pntr_app_random(app, 0, 1);
-                            random_offset_y = pntr_app_random(app, 0, 1);
-                            random_speed =  pntr_app_random_float(app, 0, 100) / 100.0f;
-                            random_awareness = pntr_app_random(app, 1, 10);
-
-                            if (PNTR_STRCMP("follow", prop->name.ptr) == 0 && prop->data.boolean) {
-                                adventure_move_object_relative_to_close_object(currentMap->map,  currentMap->layer_collisions, obj,  currentMap->player->x + random_offset_x,  currentMap->player->y + random_offset_y, random_speed, 1, random_awareness);
-                            }
-                            if (PNTR_STRCMP("avoid", prop->name.ptr) == 0 && prop->data.boolean) {
-                                adventure_move_object_relative_to_close_object(currentMap->map,  currentMap->layer_collisions, obj, currentMap->player->x + random_offset_x,  currentMap->player->y + random_offset_y, random_speed, 0, random_awareness);
-                            }
-                        }
-                    } 
-                }
-            }
-        }
+        pntr_vector camera = {0};
+        adventure_camera_look_at(&camera, screen, currentMap, currentMap->entities.player);
 
-        
-        pntr_update_tiled(currentMap->map,  dt);
-        pntr_clear_background(screen, currentMap->map->backgroundcolor ? pntr_tiled_color(currentMap->map->backgroundcolor) : PNTR_BLACK);
-        pntr_draw_tiled(screen, currentMap->map, camera.x, camera.y, PNTR_WHITE);
+        pntr_clear_background(screen, adventure_background(currentMap));
+        adventure_draw(screen, currentMap, camera.x, camera.y);
 
         if (gemCount > 0) {
-            pntr_draw_text_ex(screen, font, 10, 10, PNTR_RAYWHITE, "GEMS: %d", gemCount);
+            if (gemCount != hudGems) {
+                char gems[32];
+                snprintf(gems, sizeof(gems), "GEMS: %d", gemCount);
+                text_layout_build(&hudLayout, &texts.atlas, gems, 0);
+                hudGems = gemCount;
+            }
+            text_layout_draw(screen, &texts.atlas, &hudLayout, 10, 10);
         }
 
 #ifdef DEBUG
-            pntr_draw_text_ex(screen, font, 230, 220, PNTR_RAYWHITE, "P: %.0fx%.0f", currentMap->player->x, currentMap->player->y);
+        if (currentMap->entities.player != -1) {
+            pntr_draw_text_ex(screen, font, 230, 220, PNTR_RAYWHITE, "P: %.0fx%.0f", currentMap->entities.x[currentMap->entities.player], currentMap->entities.y[currentMap->entities.player]);
+        }
 #endif
     }
 
@@ -377,8 +773,35 @@ bool Update(pntr_app* app, pntr_image* screen) {
 // this is not used directly, but I define it, because it seems needed for web
 void Event(pntr_app* app, pntr_app_event* event) {}
 
+#ifdef PROFILER
+// the profiler wraps the whole frame & draws over it
+bool ProfiledUpdate(pntr_app* app, pntr_image* screen) {
+    profiler_frame();
+    if (pntr_app_key_pressed(app, PNTR_APP_KEY_F2)) {
+        profiler.show = !profiler.show;
+    }
+    if (pntr_app_key_pressed(app, PNTR_APP_KEY_F3)) {
+        profiler_export("trace.json");
+    }
+    bool running = Update(app, screen);
+    profiler_draw(screen, font);
+    return running;
+}
+#endif
+
 
+// ./build/lop [--record FILE | --replay FILE] [MAP]
 pntr_app Main(int argc, char* argv[]) {
+    for (int i = 1; i < argc; i++) {
+        if (PNTR_STRCMP(argv[i], "--record") == 0 && i + 1 < argc) {
+            record_file = argv[++i];
+        } else if (PNTR_STRCMP(argv[i], "--replay") == 0 && i + 1 < argc) {
+            replay_file = argv[++i];
+        } else {
+            startMap = argv[i];
+        }
+    }
+
 #ifdef PNTR_APP_RAYLIB
 #ifndef DEBUG
     SetTraceLogLevel(LOG_ERROR);
@@ -390,7 +813,11 @@ pntr_app Main(int argc, char* argv[]) {
         .height = 240,
         .title = "legend of pntr",
         .init = Init,
+#ifdef PROFILER
+        .update = ProfiledUpdate,
+#else
         .update = Update,
+#endif
         .close = Close,
         .event = Event,
         .fps = 60
@@ -0,0 +1,216 @@
+// frame profiler: times the ADVENTURE_ZONE_BEGIN/END zones, draws a graph of the last frames & exports chrome://tracing JSON
+// only built with PROFILER defined (DEBUG turns it on), otherwise the zone-hooks are empty & none of this exists
+// each thread writes finished zones into its own ring-buffer (no locks), the main thread reads them for the export
+// COLLISION is very small & very many, so it's only added up per frame (on main thread), not traced
+
+#ifdef PROFILER
+
+#ifdef __EMSCRIPTEN__
+#include <emscripten.h>
+#else
+#include <time.h>
+#endif
+#include <stdatomic.h>
+
+typedef enum profiler_zone_t {
+    PROFILER_ZONE_LOAD = 0,     // map-load
+    PROFILER_ZONE_SIM,          // a whole simulation-tick
+    PROFILER_ZONE_COMMANDS,     // timed commands
+    PROFILER_ZONE_MOVE,         // player movement
+    PROFILER_ZONE_NPC,          // NPC update (on main thread)
+    PROFILER_ZONE_INTENTS,      // a batch of NPC intents (on any thread)
+    PROFILER_ZONE_COLLISION,    // wall/object checks
+    PROFILER_ZONE_ANIMATE,      // tile-animations
+    PROFILER_ZONE_DRAW,         // drawing a map
+    PROFILER_ZONE_COUNT
+} profiler_zone_t;
+
+static const char* profiler_zone_names[PROFILER_ZONE_COUNT] = { "load", "sim", "commands", "move", "npc", "intents", "collision", "animate", "draw" };
+
+// per-thread ring-buffer of finished zones (power of 2)
+#ifndef PROFILER_RING_SIZE
+#define PROFILER_RING_SIZE 4096
+#endif
+
+// main thread, job-pool workers & the map-prefetch worker
+#ifndef PROFILER_MAX_THREADS
+#define PROFILER_MAX_THREADS 18
+#endif
+
+// frames in the on-screen graph
+#ifndef PROFILER_FRAMES
+#define PROFILER_FRAMES 120
+#endif
+
+#define ADVENTURE_ZONE_BEGIN(zone) profiler_begin(PROFILER_ZONE_##zone)
+#define ADVENTURE_ZONE_END(zone) profiler_end(PROFILER_ZONE_##zone)
+
+typedef struct profiler_event_t {
+    uint64_t start;     // ns since profiler_init
+    uint32_t duration;  // ns
+    uint32_t zone;
+} profiler_event_t;
+
+typedef struct profiler_ring_t {
+    profiler_event_t events[PROFILER_RING_SIZE];
+    _Atomic uint32_t head;  // events written so far (only its own thread writes)
+} profiler_ring_t;
+
+typedef struct profiler_t {
+    profiler_ring_t rings[PROFILER_MAX_THREADS];
+    atomic_int thread_count;
+    uint64_t origin;
+    uint64_t frame_start;
+
+    // ms per zone (main thread) for the last frames, the extra one is the whole frame
+    float frames[PROFILER_FRAMES][PROFILER_ZONE_COUNT + 1];
+    float current[PROFILER_ZONE_COUNT];
+    int frame;
+    bool show;
+} profiler_t;
+
+static profiler_t profiler;
+static _Thread_local int profiler_thread = -1;
+static _Thread_local uint64_t profiler_starts[PROFILER_ZONE_COUNT];
+
+static inline uint64_t profiler_now() {
+#ifdef __EMSCRIPTEN__
+    return (uint64_t)(emscripten_get_now() * 1000000.0);
+#elif defined(_WIN32)
+    struct timespec ts;
+    timespec_get(&ts, TIME_UTC);
+    return (uint64_t)ts.tv_sec * 1000000000ull + ts.tv_nsec;
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + ts.tv_nsec;
+#endif
+}
+
+// index of the calling thread (it gets one the first time it finishes a zone), or -1 if there are too many
+static inline int profiler_thread_index() {
+    if (profiler_thread == -1) {
+        int index = atomic_fetch_add(&profiler.thread_count, 1);
+        profiler_thread = index < PROFILER_MAX_THREADS ? index : -2;
+    }
+    return profiler_thread;
+}
+
+// start profiling, call on main thread (so it's thread 0) before anything else
+void profiler_init() {
+    memset(&profiler, 0, sizeof(profiler_t));
+    profiler.origin = profiler_now();
+    profiler.frame_start = profiler.origin;
+    profiler_thread = -1;
+    profiler_thread_index();
+}
+
+static inline void profiler_begin(profiler_zone_t zone) {
+    profiler_starts[zone] = profiler_now();
+}
+
+static inline void profiler_end(profiler_zone_t zone) {
+    uint64_t end = profiler_now();
+    uint64_t start = profiler_starts[zone];
+    int thread = profiler_thread_index();
+    if (thread == 0) {
+        profiler.current[zone] += (end - start) / 1000000.0f;
+    }
+    if (thread < 0 || zone == PROFILER_ZONE_COLLISION) {
+        return;
+    }
+    profiler_ring_t* ring = &profiler.rings[thread];
+    uint32_t head = atomic_load_explicit(&ring->head, memory_order_relaxed);
+    profiler_event_t* event = &ring->events[head & (PROFILER_RING_SIZE - 1)];
+    event->start = start - profiler.origin;
+    event->duration = (uint32_t)(end - start);
+    event->zone = zone;
+    atomic_store_explicit(&ring->head, head + 1, memory_order_release);
+}
+
+// call once per frame (on main thread), it closes the last frame for the graph
+void profiler_frame() {
+    uint64_t now = profiler_now();
+    float* frame = profiler.frames[profiler.frame];
+    memcpy(frame, profiler.current, sizeof(profiler.current));
+    frame[PROFILER_ZONE_COUNT] = (now - profiler.frame_start) / 1000000.0f;
+    memset(profiler.current, 0, sizeof(profiler.current));
+    profiler.frame = (profiler.frame + 1) % PROFILER_FRAMES;
+    profiler.frame_start = now;
+}
+
+// stacked bars of the last frames (oldest on the left), 4px per ms, with a line at 60fps
+void profiler_draw(pntr_image* dst, pntr_font* font) {
+    if (!profiler.show || dst == NULL) {
+        return;
+    }
+    const pntr_color colors[PROFILER_ZONE_COUNT] = {
+        PNTR_ORANGE, PNTR_DARKGRAY, PNTR_PURPLE, PNTR_SKYBLUE, PNTR_GREEN, PNTR_DARKGREEN, PNTR_RED, PNTR_YELLOW, PNTR_BLUE
+    };
+    int bottom = dst->height - 2;
+    int left = 2;
+    pntr_draw_rectangle_fill(dst, left, bottom - 100, PROFILER_FRAMES * 2, 100, pntr_new_color(0, 0, 0, 160));
+
+    float average[PROFILER_ZONE_COUNT + 1] = {0};
+    for (int i = 0; i < PROFILER_FRAMES; i++) {
+        float* frame = profiler.frames[(profiler.frame + i) % PROFILER_FRAMES];
+        int x = left + i * 2;
+        int total = (int)(frame[PROFILER_ZONE_COUNT] * 4);
+        pntr_draw_line(dst, x, bottom, x, bottom - (total < 100 ? total : 100), PNTR_GRAY);
+
+        // SIM contains most of the others, so it's not stacked (it's the gray under them)
+        int y = bottom;
+        for (int z = 0; z < PROFILER_ZONE_COUNT; z++) {
+            average[z] += frame[z] / PROFILER_FRAMES;
+            if (z == PROFILER_ZONE_SIM || z == PROFILER_ZONE_INTENTS || z == PROFILER_ZONE_COLLISION) {
+                continue;
+            }
+            int height = (int)(frame[z] * 4);
+            if (height > 0 && y - height > bottom - 100) {
+                pntr_draw_line(dst, x, y, x, y - height, colors[z]);
+                y -= height;
+            }
+        }
+        average[PROFILER_ZONE_COUNT] += frame[PROFILER_ZONE_COUNT] / PROFILER_FRAMES;
+    }
+    int line = bottom - (int)(1000.0f / 60.0f * 4);
+    pntr_draw_line(dst, left, line, left + PROFILER_FRAMES * 2, line, PNTR_WHITE);
+
+    if (font != NULL) {
+        pntr_draw_text_ex(dst, font, left + PROFILER_FRAMES * 2 + 4, bottom - 100, PNTR_WHITE, "frame %.2fms", average[PROFILER_ZONE_COUNT]);
+        for (int z = 0; z < PROFILER_ZONE_COUNT; z++) {
+            pntr_draw_text_ex(dst, font, left + PROFILER_FRAMES * 2 + 4, bottom - 90 + z * 10, colors[z], "%s %.2f", profiler_zone_names[z], average[z]);
+        }
+    }
+}
+
+// write everything still in the ring-buffers as chrome://tracing (or https://ui.perfetto.dev) JSON
+bool profiler_export(const char* filename) {
+    FILE* file = fopen(filename, "w");
+    if (file == NULL) {
+        pntr_app_log_ex(PNTR_APP_LOG_WARNING, "Profiler: could not write '%s'", filename);
+        return false;
+    }
+    fprintf(file, "{\"traceEvents\":[\n");
+    bool first = true;
+    int threads = atomic_load(&profiler.thread_count);
+    for (int t = 0; t < threads && t < PROFILER_MAX_THREADS; t++) {
+        profiler_ring_t* ring = &profiler.rings[t];
+        uint32_t head = atomic_load_explicit(&ring->head, memory_order_acquire);
+        uint32_t tail = head > PROFILER_RING_SIZE ? head - PROFILER_RING_SIZE : 0;
+
+        // the oldest few can be overwritten while this runs (other threads don't stop), that's fine for a profile
+        for (uint32_t i = tail; i < head; i++) {
+            profiler_event_t* event = &ring->events[i & (PROFILER_RING_SIZE - 1)];
+            fprintf(file, "%s{\"name\":\"%s\",\"ph\":\"X\",\"pid\":0,\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f}",
+                first ? "" : ",\n", profiler_zone_names[event->zone % PROFILER_ZONE_COUNT], t, event->start / 1000.0, event->duration / 1000.0);
+            first = false;
+        }
+    }
+    fprintf(file, "\n]}\n");
+    fclose(file);
+    pntr_app_log_ex(PNTR_APP_LOG_INFO, "Profiler: wrote '%s'", filename);
+    return true;
+}
+
+#endif
@@ -0,0 +1,218 @@
+// this is a cache for sfx/sounds (see asset_cache.h)
+// it lets you just load the sound, and if it's already been loaded, it will return that.
+// hold on to the handle from asset_cache_intern to skip the lookup.
+// loading is ok off the main thread, so sounds can be synthesized in the background (with adventure_prefetch_t)
+// that only makes the .wav bytes, the pntr_sound is made from them on the main thread (in sound_cache_finish)
+
+// rfx sounds are synthesized once, & if SOUND_PCM_DIR is defined (native builds use build/sounds) the samples are saved
+// there (as .wav), named by a hash of the .rfx, like coin.rfx -> build/sounds/coin.0123456789abcdef.wav.
+// later runs just load that, & a changed .rfx gets a new hash, so it's made again. bump SOUND_PCM_VERSION if synthesis changes.
+// without it (web) they are synthesized every run.
+#ifndef SOUND_PCM_VERSION
+#define SOUND_PCM_VERSION 1
+#endif
+
+#include "pntr_app_sfx.h"
+#include "sound_synth.h"
+
+// short rfx sounds, we don't know real size of pntr_sound, so this is a guess for the cache-budget (when there are no samples to go by)
+#ifndef SOUND_ESTIMATED_BYTES
+#define SOUND_ESTIMATED_BYTES (64 * 1024)
+#endif
+
+typedef struct sound_holder_t {
+    pntr_sound* sound;
+    unsigned char* wav;         // loaded/synthesized file, until sound_cache_finish makes sound from it
+    unsigned int wav_size;
+    pntr_app_sound_type type;
+    SfxParams* params;
+    float length;       // in seconds, 0 if it isn't known (only .wav headers are read)
+} sound_holder_t;
+
+// FNV-1a of an .rfx file (& SOUND_PCM_VERSION), 0 if it can't be read
+static uint64_t sound_pcm_hash(const char* filename) {
+    unsigned int size = 0;
+    unsigned char* data = pntr_load_file(filename, &size);
+    if (data == NULL) {
+        return 0;
+    }
+    uint64_t hash = (0xCBF29CE484222325ull ^ SOUND_PCM_VERSION) * 0x100000001B3ull;
+    for (unsigned int i = 0; i < size; i++) {
+        hash = (hash ^ data[i]) * 0x100000001B3ull;
+    }
+    pntr_unload_memory(data);
+    return hash;
+}
+
+// where the samples for an .rfx go (in SOUND_PCM_DIR, same name, with its hash & .wav)
+// false if they aren't saved, or the .rfx can't be read
+static bool sound_pcm_path(const char* filename, char* out, size_t size) {
+#ifdef SOUND_PCM_DIR
+    uint64_t hash = sound_pcm_hash(filename);
+    if (hash == 0) {
+        return false;
+    }
+    const char* slash = strrchr(filename, '/');
+    snprintf(out, size, "%s/%s", SOUND_PCM_DIR, slash != NULL ? slash + 1 : filename);
+    char* dot = strrchr(out, '.');
+    if (dot != NULL && dot > out + PNTR_STRLEN(SOUND_PCM_DIR)) {
+        *dot = 0;
+    }
+    size_t len = PNTR_STRLEN(out);
+    snprintf(out + len, size - len, ".%016llx.wav", (unsigned long long)hash);
+    return true;
+#else
+    return false;
+#endif
+}
+
+static inline uint32_t sound_u32(const unsigned char* p) {
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+// seconds of sound in a .wav, from its header (the start of the file is enough), 0 if it can't tell
+static float sound_wav_length(const unsigned char* data, size_t size) {
+    if (size < 12 || memcmp(data, "RIFF", 4) != 0 || memcmp(data + 8, "WAVE", 4) != 0) {
+        return 0;
+    }
+    uint32_t byte_rate = 0;
+    size_t pos = 12;
+    while (pos + 8 <= size) {
+        uint32_t chunk = sound_u32(data + pos + 4);
+        if (memcmp(data + pos, "fmt ", 4) == 0 && pos + 20 <= size) {
+            byte_rate = sound_u32(data + pos + 16);
+        } else if (memcmp(data + pos, "data", 4) == 0) {
+            return byte_rate > 0 ? (float)chunk / byte_rate : 0;
+        }
+        pos += 8 + chunk + (chunk & 1);
+    }
+    return 0;
+}
+
+// size of a file & how long it plays (if it's a .wav), 0 if it isn't there
+static size_t sound_file_info(const char* filename, float* length) {
+    *length = 0;
+    FILE* f = fopen(filename, "rb");
+    if (f == NULL) {
+        return 0;
+    }
+    unsigned char header[256];
+    *length = sound_wav_length(header, fread(header, 1, sizeof(header), f));
+    fseek(f, 0, SEEK_END);
+    long size = ftell(f);
+    fclose(f);
+    return size > 0 ? (size_t)size : 0;
+}
+
+// write samples (to a temp-file that is renamed, so 2 runs at once never see half a file)
+static void sound_pcm_save(const char* filename, const unsigned char* data, unsigned int size) {
+#ifdef SOUND_PCM_DIR
+    char temp[PNTR_PATH_MAX];
+    snprintf(temp, sizeof(temp), "%s.tmp", filename);
+    FILE* f = fopen(temp, "wb");
+    if (f == NULL) {
+        return;
+    }
+    bool written = fwrite(data, 1, size, f) == size;
+    written = fclose(f) == 0 && written;
+    if (!written || rename(temp, filename) != 0) {
+        remove(temp);
+        return;
+    }
+    pntr_app_log_ex(PNTR_APP_LOG_DEBUG, "Sound: saved samples to '%s'", filename);
+#endif
+}
+
+// AssetLoadFn for asset_cache_t of sounds (userdata is pntr_app), ok on any thread
+// files ending in .rfx are loaded from their saved samples, or synthesized (& saved), everything else is loaded as a regular sound
+void* sound_cache_load(const char* filename, void* userdata, size_t* bytes) {
+    sound_holder_t* current = pntr_load_memory(sizeof(sound_holder_t));
+    if (current == NULL) {
+        return NULL;
+    }
+    memset(current, 0, sizeof(sound_holder_t));
+    current->type = PNTR_APP_SOUND_TYPE_WAV;
+
+    size_t len = PNTR_STRLEN(filename);
+    if (len > 4 && PNTR_STRCMP(filename + len - 4, ".rfx") == 0) {
+        char pcm[PNTR_PATH_MAX];
+        bool hashed = sound_pcm_path(filename, pcm, sizeof(pcm));
+        if (hashed && sound_file_info(pcm, &current->length) > 0) {
+            pntr_app_log_ex(PNTR_APP_LOG_DEBUG, "Sound: loading '%s' for '%s'", pcm, filename);
+            current->wav = pntr_load_file(pcm, &current->wav_size);
+        }
+        if (current->wav == NULL) {
+            pntr_app_log_ex(PNTR_APP_LOG_DEBUG, "Sound: synthesizing '%s'", filename);
+            current->params = pntr_load_memory(sizeof(SfxParams));
+            if (current->params == NULL) {
+                pntr_unload_memory(current);
+                return NULL;
+            }
+            pntr_app_sfx_load_params(current->params, filename);
+            current->wav = sound_synth_wav(current->params, &current->wav_size);
+            current->length = sound_wav_length(current->wav, current->wav_size);
+            if (hashed && current->wav != NULL) {
+                sound_pcm_save(pcm, current->wav, current->wav_size);
+            }
+        }
+    } else {
+        pntr_app_log_ex(PNTR_APP_LOG_DEBUG, "Sound: loading '%s'", filename);
+        current->wav = pntr_load_file(filename, &current->wav_size);
+        current->length = sound_wav_length(current->wav, current->wav_size);
+        if (len > 4 && PNTR_STRCMP(filename + len - 4, ".ogg") == 0) {
+            current->type = PNTR_APP_SOUND_TYPE_OGG;
+        }
+    }
+
+    size_t samples = current->wav_size;
+    *bytes = sizeof(sound_holder_t) + (current->params ? sizeof(SfxParams) : 0) + (samples > 0 ? samples : SOUND_ESTIMATED_BYTES);
+    return current;
+}
+
+// AssetFinishFn for asset_cache_t of sounds, makes the pntr_sound (on main thread, backends don't like that on others)
+void sound_cache_finish(void* data, void* userdata) {
+    sound_holder_t* holder = (sound_holder_t*)data;
+    if (holder->sound == NULL && holder->wav != NULL) {
+        // that takes the bytes
+        holder->sound = pntr_load_sound_from_memory(holder->type, holder->wav, holder->wav_size);
+    }
+    holder->wav = NULL;
+    holder->wav_size = 0;
+}
+
+// AssetUnloadFn for asset_cache_t of sounds
+void sound_cache_unload(void* data, void* userdata) {
+    sound_holder_t* holder = (sound_holder_t*)data;
+    if (holder == NULL) {
+        return;
+    }
+    if (holder->sound != NULL) {
+        pntr_unload_sound(holder->sound);
+    }
+    if (holder->wav != NULL) {
+        pntr_unload_memory(holder->wav);
+    }
+    if (holder->params != NULL) {
+        pntr_unload_memory(holder->params);
+    }
+    pntr_unload_memory(holder);
+}
+
+// set up a cache for sounds, budget is in bytes (0 for unlimited)
+void sound_cache_init(asset_cache_t* sounds, pntr_app* app, size_t budget) {
+    asset_cache_init(sounds, 16, budget, sound_cache_load, sound_cache_unload, app);
+    sounds->finish = sound_cache_finish;
+}
+
+// add/get a sound (or sound-effect, if it's .rfx)
+sound_holder_t* sound_load(asset_cache_t* sounds, const char* filename) {
+    return asset_cache_load(sounds, filename);
+}
+
+// play a sound by handle (from asset_cache_intern)
+void sound_play(asset_cache_t* sounds, asset_handle_t handle) {
+    sound_holder_t* s = asset_cache_get(sounds, handle);
+    if (s != NULL && s->sound != NULL) {
+        pntr_play_sound(s->sound, false);
+    }
+}
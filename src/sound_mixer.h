@@ -0,0 +1,207 @@
+// voice-pooled playback, on top of the sound-cache (see sound_cache.h)
+// sound_mixer_play() only asks for a sound, everything asked for in a frame is played together in sound_mixer_submit()
+// there is a fixed pool of voices, & each sound has a max number of voices, a cooldown (since it last started) & a priority:
+// - the same sound asked for more than once in a frame (or again in its cooldown) plays once
+// - a sound that is at its max restarts its oldest voice
+// - if the pool is full, the lowest-priority voice (oldest first) is stopped for it, unless that is higher-priority than it
+// a playing sound is acquired from the cache, so it can't be unloaded under a voice
+// pntr_app has no per-voice control, so on backends where a pntr_sound only plays once at a time, more voices of it just restart it
+
+#ifndef SOUND_MIXER_VOICES
+#define SOUND_MIXER_VOICES 8
+#endif
+
+// most requests in a frame, & sounds with their own settings
+#ifndef SOUND_MIXER_REQUESTS
+#define SOUND_MIXER_REQUESTS 32
+#endif
+#ifndef SOUND_MIXER_SOUNDS
+#define SOUND_MIXER_SOUNDS 32
+#endif
+
+// settings for sounds that were never given any
+#ifndef SOUND_MIXER_DEFAULT_VOICES
+#define SOUND_MIXER_DEFAULT_VOICES 2
+#endif
+#ifndef SOUND_MIXER_DEFAULT_COOLDOWN
+#define SOUND_MIXER_DEFAULT_COOLDOWN 0.05f
+#endif
+
+// how long a voice is held, if the sound's length isn't known
+#ifndef SOUND_MIXER_DEFAULT_LENGTH
+#define SOUND_MIXER_DEFAULT_LENGTH 1.0f
+#endif
+
+typedef struct sound_mixer_sound_t {
+    asset_handle_t handle;
+    int max_voices;
+    float cooldown;         // in seconds
+    int priority;           // higher steals lower
+    float last_start;       // mixer-time, < 0 if it never played
+} sound_mixer_sound_t;
+
+typedef struct sound_mixer_voice_t {
+    asset_handle_t handle;  // 0 if free
+    sound_holder_t* holder;
+    int priority;
+    float start;
+    float end;
+} sound_mixer_voice_t;
+
+typedef struct sound_mixer_t {
+    asset_cache_t* sounds;
+    float time;
+
+    sound_mixer_voice_t voices[SOUND_MIXER_VOICES];
+    sound_mixer_sound_t settings[SOUND_MIXER_SOUNDS];
+    int settings_count;
+
+    asset_handle_t requests[SOUND_MIXER_REQUESTS];
+    int request_count;
+} sound_mixer_t;
+
+void sound_mixer_init(sound_mixer_t* mixer, asset_cache_t* sounds) {
+    memset(mixer, 0, sizeof(sound_mixer_t));
+    mixer->sounds = sounds;
+}
+
+// settings for a sound, added with defaults the first time (NULL if there's no room)
+static sound_mixer_sound_t* sound_mixer_find(sound_mixer_t* mixer, asset_handle_t handle) {
+    for (int i = 0; i < mixer->settings_count; i++) {
+        if (mixer->settings[i].handle == handle) {
+            return &mixer->settings[i];
+        }
+    }
+    if (mixer->settings_count == SOUND_MIXER_SOUNDS) {
+        return NULL;
+    }
+    sound_mixer_sound_t* sound = &mixer->settings[mixer->settings_count++];
+    sound->handle = handle;
+    sound->max_voices = SOUND_MIXER_DEFAULT_VOICES;
+    sound->cooldown = SOUND_MIXER_DEFAULT_COOLDOWN;
+    sound->priority = 0;
+    sound->last_start = -1;
+    return sound;
+}
+
+// set how a sound plays: how many voices it can have at once (at least 1), seconds before it can start again, & priority
+void sound_mixer_set(sound_mixer_t* mixer, asset_handle_t handle, int max_voices, float cooldown, int priority) {
+    sound_mixer_sound_t* sound = handle == 0 ? NULL : sound_mixer_find(mixer, handle);
+    if (sound != NULL) {
+        sound->max_voices = MAX(max_voices, 1);
+        sound->cooldown = cooldown;
+        sound->priority = priority;
+    }
+}
+
+// let go of a voice (stopping it, if it is still playing)
+static void sound_mixer_free_voice(sound_mixer_t* mixer, sound_mixer_voice_t* voice, bool stop) {
+    if (voice->handle == 0) {
+        return;
+    }
+    if (stop && voice->holder != NULL && voice->holder->sound != NULL) {
+        pntr_stop_sound(voice->holder->sound);
+    }
+    asset_cache_release(mixer->sounds, voice->handle);
+    memset(voice, 0, sizeof(sound_mixer_voice_t));
+}
+
+// ask for a sound to play (by handle, from asset_cache_intern), it starts in the next sound_mixer_submit()
+void sound_mixer_play(sound_mixer_t* mixer, asset_handle_t handle) {
+    if (handle == 0 || mixer->request_count == SOUND_MIXER_REQUESTS) {
+        return;
+    }
+    for (int i = 0; i < mixer->request_count; i++) {
+        if (mixer->requests[i] == handle) {
+            return;
+        }
+    }
+    mixer->requests[mixer->request_count++] = handle;
+}
+
+// advance the mixer's clock & free voices that finished (once per frame)
+void sound_mixer_update(sound_mixer_t* mixer, float dt) {
+    mixer->time += dt;
+    for (int i = 0; i < SOUND_MIXER_VOICES; i++) {
+        if (mixer->voices[i].handle != 0 && mixer->time >= mixer->voices[i].end) {
+            sound_mixer_free_voice(mixer, &mixer->voices[i], false);
+        }
+    }
+}
+
+// pick a voice for a sound, or NULL if everything playing is more important
+static sound_mixer_voice_t* sound_mixer_pick(sound_mixer_t* mixer, sound_mixer_sound_t* sound) {
+    // at its max: restart its oldest voice
+    int count = 0;
+    sound_mixer_voice_t* oldest = NULL;
+    for (int i = 0; i < SOUND_MIXER_VOICES; i++) {
+        sound_mixer_voice_t* voice = &mixer->voices[i];
+        if (voice->handle == sound->handle) {
+            count++;
+            if (oldest == NULL || voice->start < oldest->start) {
+                oldest = voice;
+            }
+        }
+    }
+    if (count >= sound->max_voices) {
+        return oldest;
+    }
+
+    // a free voice, or steal the least important one
+    sound_mixer_voice_t* victim = NULL;
+    for (int i = 0; i < SOUND_MIXER_VOICES; i++) {
+        sound_mixer_voice_t* voice = &mixer->voices[i];
+        if (voice->handle == 0) {
+            return voice;
+        }
+        if (victim == NULL || voice->priority < victim->priority || (voice->priority == victim->priority && voice->start < victim->start)) {
+            victim = voice;
+        }
+    }
+    return victim != NULL && victim->priority <= sound->priority ? victim : NULL;
+}
+
+// play everything that was asked for since the last submit (once per frame, after anything that plays sounds)
+void sound_mixer_submit(sound_mixer_t* mixer) {
+    for (int r = 0; r < mixer->request_count; r++) {
+        sound_mixer_sound_t fallback = { mixer->requests[r], SOUND_MIXER_DEFAULT_VOICES, 0, 0, -1 };
+        sound_mixer_sound_t* sound = sound_mixer_find(mixer, mixer->requests[r]);
+        if (sound == NULL) {
+            sound = &fallback;
+        }
+        if (sound->last_start >= 0 && mixer->time - sound->last_start < sound->cooldown) {
+            continue;
+        }
+        sound_mixer_voice_t* voice = sound_mixer_pick(mixer, sound);
+        if (voice == NULL) {
+            continue;
+        }
+
+        // loads it, if it isn't yet
+        sound_holder_t* holder = asset_cache_acquire(mixer->sounds, sound->handle);
+        if (holder == NULL) {
+            continue;
+        }
+        if (holder->sound == NULL) {
+            asset_cache_release(mixer->sounds, sound->handle);
+            continue;
+        }
+        sound_mixer_free_voice(mixer, voice, voice->handle != sound->handle);
+        voice->handle = sound->handle;
+        voice->holder = holder;
+        voice->priority = sound->priority;
+        voice->start = mixer->time;
+        voice->end = mixer->time + (holder->length > 0 ? holder->length : SOUND_MIXER_DEFAULT_LENGTH);
+        sound->last_start = mixer->time;
+        pntr_play_sound(holder->sound, false);
+    }
+    mixer->request_count = 0;
+}
+
+// stop everything & let go of the sounds (before the sound-cache is freed)
+void sound_mixer_unload(sound_mixer_t* mixer) {
+    for (int i = 0; i < SOUND_MIXER_VOICES; i++) {
+        sound_mixer_free_voice(mixer, &mixer->voices[i], true);
+    }
+    mixer->request_count = 0;
+}
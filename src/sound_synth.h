@@ -0,0 +1,281 @@
+// turns pntr_app_sfx's SfxParams (a loaded .rfx) into a .wav in memory, without making a pntr_sound
+// pntr_app_sfx_sound() synthesizes & creates the sound in one go, so this is the generator it's built on (rFXGen's GenerateWave),
+// noise comes from pntr_app's random (pntr_app_random, like pntr_app_sfx), seeded with the params' randSeed,
+// on a pntr_app of its own, so it doesn't touch the game's stream & is ok to run on any thread
+
+#ifndef SOUND_SYNTH_RATE
+#define SOUND_SYNTH_RATE 44100
+#endif
+
+// longest sound it will make, in seconds
+#ifndef SOUND_SYNTH_MAX_SECONDS
+#define SOUND_SYNTH_MAX_SECONDS 10
+#endif
+
+#define SOUND_SYNTH_SUPERSAMPLING 8
+
+// 0 to range (rFXGen's GetRandomFloat)
+static inline float sound_synth_random(pntr_app* rng, float range) {
+    return (float)pntr_app_random(rng, 0, 10000) / 10000.0f * range;
+}
+
+static inline void sound_synth_u16(unsigned char* p, uint16_t v) {
+    p[0] = v & 0xFF;
+    p[1] = (v >> 8) & 0xFF;
+}
+
+static inline void sound_synth_u32(unsigned char* p, uint32_t v) {
+    sound_synth_u16(p, v & 0xFFFF);
+    sound_synth_u16(p + 2, v >> 16);
+}
+
+// state that is reset at the start, & again each time the sound repeats
+typedef struct sound_synth_period_t {
+    double fperiod;
+    double fmaxperiod;
+    double fslide;
+    double fdslide;
+    float square_duty;
+    float square_slide;
+    double arp_mod;
+    int arp_time;
+    int arp_limit;
+} sound_synth_period_t;
+
+static void sound_synth_reset(const SfxParams* p, sound_synth_period_t* s) {
+    s->fperiod = 100.0 / (p->startFrequencyValue * p->startFrequencyValue + 0.001);
+    s->fmaxperiod = 100.0 / (p->minFrequencyValue * p->minFrequencyValue + 0.001);
+    s->fslide = 1.0 - pow((double)p->slideValue, 3.0) * 0.01;
+    s->fdslide = -pow((double)p->deltaSlideValue, 3.0) * 0.000001;
+    s->square_duty = 0.5f - p->squareDutyValue * 0.5f;
+    s->square_slide = -p->dutySweepValue * 0.00005f;
+    if (p->changeAmountValue >= 0.0f) {
+        s->arp_mod = 1.0 - pow((double)p->changeAmountValue, 2.0) * 0.9;
+    } else {
+        s->arp_mod = 1.0 + pow((double)p->changeAmountValue, 2.0) * 10.0;
+    }
+    s->arp_time = 0;
+    s->arp_limit = p->changeSpeedValue == 1.0f ? 0 : (int)(powf(1.0f - p->changeSpeedValue, 2.0f) * 20000 + 32);
+}
+
+// synthesize a sound, as a 16-bit mono .wav (free it with pntr_unload_memory), NULL if it can't
+unsigned char* sound_synth_wav(const SfxParams* p, unsigned int* size) {
+    *size = 0;
+    pntr_app random;
+    memset(&random, 0, sizeof(random));
+    pntr_app_random_seed(&random, (unsigned int)p->randSeed);
+
+    sound_synth_period_t s;
+    sound_synth_reset(p, &s);
+
+    // filters
+    float fltp = 0.0f;
+    float fltdp = 0.0f;
+    float fltw = powf(p->lpfCutoffValue, 3.0f) * 0.1f;
+    float fltwd = 1.0f + p->lpfCutoffSweepValue * 0.0001f;
+    float fltdmp = 5.0f / (1.0f + powf(p->lpfResonanceValue, 2.0f) * 20.0f) * (0.01f + fltw);
+    if (fltdmp > 0.8f) {
+        fltdmp = 0.8f;
+    }
+    float fltphp = 0.0f;
+    float flthp = powf(p->hpfCutoffValue, 2.0f) * 0.1f;
+    float flthpd = 1.0f + p->hpfCutoffSweepValue * 0.0003f;
+
+    float vib_phase = 0.0f;
+    float vib_speed = powf(p->vibratoSpeedValue, 2.0f) * 0.01f;
+    float vib_amp = p->vibratoDepthValue * 0.5f;
+
+    int env_stage = 0;
+    int env_time = 0;
+    int env_length[3] = {
+        (int)(p->attackTimeValue * p->attackTimeValue * 100000.0f),
+        (int)(p->sustainTimeValue * p->sustainTimeValue * 100000.0f),
+        (int)(p->decayTimeValue * p->decayTimeValue * 100000.0f)
+    };
+    float env_vol = 0.0f;
+
+    float fphase = powf(p->phaserOffsetValue, 2.0f) * 1020.0f * (p->phaserOffsetValue < 0.0f ? -1.0f : 1.0f);
+    float fdphase = powf(p->phaserSweepValue, 2.0f) * (p->phaserSweepValue < 0.0f ? -1.0f : 1.0f);
+    int iphase = abs((int)fphase);
+    int ipp = 0;
+    float phaser_buffer[1024] = {0};
+
+    float noise_buffer[32];
+    for (int i = 0; i < 32; i++) {
+        noise_buffer[i] = sound_synth_random(&random, 2.0f) - 1.0f;
+    }
+
+    int rep_time = 0;
+    int rep_limit = p->repeatSpeedValue == 0.0f ? 0 : (int)(powf(1.0f - p->repeatSpeedValue, 2.0f) * 20000 + 32);
+
+    // 44-byte header, then samples (copied into one that fits, when it's done)
+    unsigned int max_samples = SOUND_SYNTH_RATE * SOUND_SYNTH_MAX_SECONDS;
+    unsigned char* buffer = pntr_load_memory(44 + max_samples * 2);
+    if (buffer == NULL) {
+        return NULL;
+    }
+    unsigned int count = 0;
+    int phase = 0;
+
+    while (count < max_samples) {
+        rep_time++;
+        if (rep_limit != 0 && rep_time >= rep_limit) {
+            rep_time = 0;
+            sound_synth_reset(p, &s);
+        }
+
+        // frequency envelopes/arpeggios
+        s.arp_time++;
+        if (s.arp_limit != 0 && s.arp_time >= s.arp_limit) {
+            s.arp_limit = 0;
+            s.fperiod *= s.arp_mod;
+        }
+        s.fslide += s.fdslide;
+        s.fperiod *= s.fslide;
+        if (s.fperiod > s.fmaxperiod) {
+            s.fperiod = s.fmaxperiod;
+            if (p->minFrequencyValue > 0.0f) {
+                break;
+            }
+        }
+        float rfperiod = (float)s.fperiod;
+        if (vib_amp > 0.0f) {
+            vib_phase += vib_speed;
+            rfperiod = (float)s.fperiod * (1.0f + sinf(vib_phase) * vib_amp);
+        }
+        int period = (int)rfperiod;
+        if (period < 8) {
+            period = 8;
+        }
+        s.square_duty += s.square_slide;
+        if (s.square_duty < 0.0f) {
+            s.square_duty = 0.0f;
+        }
+        if (s.square_duty > 0.5f) {
+            s.square_duty = 0.5f;
+        }
+
+        // volume envelope
+        env_time++;
+        if (env_time > env_length[env_stage]) {
+            env_time = 0;
+            env_stage++;
+            if (env_stage == 3) {
+                break;
+            }
+        }
+        if (env_stage == 0) {
+            env_vol = env_length[0] > 0 ? (float)env_time / env_length[0] : 1.0f;
+        } else if (env_stage == 1) {
+            env_vol = 1.0f + (1.0f - (env_length[1] > 0 ? (float)env_time / env_length[1] : 1.0f)) * 2.0f * p->sustainPunchValue;
+        } else {
+            env_vol = 1.0f - (env_length[2] > 0 ? (float)env_time / env_length[2] : 1.0f);
+        }
+
+        // phaser step
+        fphase += fdphase;
+        iphase = abs((int)fphase);
+        if (iphase > 1023) {
+            iphase = 1023;
+        }
+
+        if (flthpd != 0.0f) {
+            flthp *= flthpd;
+            if (flthp < 0.00001f) {
+                flthp = 0.00001f;
+            }
+            if (flthp > 0.1f) {
+                flthp = 0.1f;
+            }
+        }
+
+        float ssample = 0.0f;
+        for (int si = 0; si < SOUND_SYNTH_SUPERSAMPLING; si++) {
+            float sample = 0.0f;
+            phase++;
+            if (phase >= period) {
+                phase %= period;
+                if (p->waveTypeValue == 3) {
+                    for (int i = 0; i < 32; i++) {
+                        noise_buffer[i] = sound_synth_random(&random, 2.0f) - 1.0f;
+                    }
+                }
+            }
+
+            // base waveform
+            float fp = (float)phase / period;
+            switch (p->waveTypeValue) {
+                case 0: sample = fp < s.square_duty ? 0.5f : -0.5f; break;  // square
+                case 1: sample = 1.0f - fp * 2; break;                      // sawtooth
+                case 2: sample = sinf(fp * 2 * PNTR_PI); break;              // sine
+                case 3: sample = noise_buffer[phase * 32 / period]; break;  // noise
+                default: break;
+            }
+
+            // low-pass filter
+            float pp = fltp;
+            fltw *= fltwd;
+            if (fltw < 0.0f) {
+                fltw = 0.0f;
+            }
+            if (fltw > 0.1f) {
+                fltw = 0.1f;
+            }
+            if (p->lpfCutoffValue != 1.0f) {
+                fltdp += (sample - fltp) * fltw;
+                fltdp -= fltdp * fltdmp;
+            } else {
+                fltp = sample;
+                fltdp = 0.0f;
+            }
+            fltp += fltdp;
+
+            // high-pass filter
+            fltphp += fltp - pp;
+            fltphp -= fltphp * flthp;
+            sample = fltphp;
+
+            // phaser
+            phaser_buffer[ipp & 1023] = sample;
+            sample += phaser_buffer[(ipp - iphase + 1024) & 1023];
+            ipp = (ipp + 1) & 1023;
+
+            ssample += sample * env_vol;
+        }
+
+        // scaled to -1..1
+        ssample = ssample / SOUND_SYNTH_SUPERSAMPLING * 0.2f;
+        if (ssample > 1.0f) {
+            ssample = 1.0f;
+        }
+        if (ssample < -1.0f) {
+            ssample = -1.0f;
+        }
+        sound_synth_u16(buffer + 44 + count * 2, (uint16_t)(int16_t)(ssample * 32767.0f));
+        count++;
+    }
+
+    unsigned char* wav = count > 0 ? pntr_load_memory(44 + count * 2) : NULL;
+    if (wav != NULL) {
+        memcpy(wav + 44, buffer + 44, count * 2);
+    }
+    pntr_unload_memory(buffer);
+    if (wav == NULL) {
+        return NULL;
+    }
+
+    memcpy(wav, "RIFF", 4);
+    sound_synth_u32(wav + 4, 36 + count * 2);
+    memcpy(wav + 8, "WAVEfmt ", 8);
+    sound_synth_u32(wav + 16, 16);
+    sound_synth_u16(wav + 20, 1);  // PCM
+    sound_synth_u16(wav + 22, 1);  // mono
+    sound_synth_u32(wav + 24, SOUND_SYNTH_RATE);
+    sound_synth_u32(wav + 28, SOUND_SYNTH_RATE * 2);
+    sound_synth_u16(wav + 32, 2);
+    sound_synth_u16(wav + 34, 16);
+    memcpy(wav + 36, "data", 4);
+    sound_synth_u32(wav + 40, count * 2);
+    *size = 44 + count * 2;
+    return wav;
+}
@@ -0,0 +1,238 @@
+// text that is laid out once & drawn as a run of blits
+// a font's glyphs are copied (already tinted) into 1 atlas-image, with a byte -> glyph table, so drawing needs no search or tint
+// layouts (where each glyph of a string goes, wrapped to a width) are kept in an asset_cache_t keyed on width & string:
+// intern a string once (text_cache_intern) & draw it by handle every frame, with nothing measured or formatted
+// text that changes (like a counter) can have its own text_layout_t, & only re-build it when it changes
+
+#ifndef TEXT_CACHE_BUDGET
+#define TEXT_CACHE_BUDGET (64 * 1024)
+#endif
+
+typedef struct text_glyph_t {
+    pntr_rectangle src;     // in the atlas
+    int16_t x;              // offset to draw at
+    int16_t y;
+    int16_t advance;
+    uint8_t blit;           // adventure_blit_kind_t
+} text_glyph_t;
+
+typedef struct text_atlas_t {
+    pntr_image* image;
+    text_glyph_t* glyphs;
+    int glyph_count;
+    int16_t lookup[256];    // byte -> glyph, or -1
+    int line_height;
+} text_atlas_t;
+
+// a glyph placed in a layout
+typedef struct text_placed_t {
+    int16_t x;
+    int16_t y;
+    int16_t glyph;
+} text_placed_t;
+
+typedef struct text_layout_t {
+    text_placed_t* placed;
+    int count;
+    int capacity;
+    int width;              // of the widest line
+    int height;
+} text_layout_t;
+
+typedef struct text_cache_t {
+    text_atlas_t atlas;
+    asset_cache_t layouts;
+} text_cache_t;
+
+// copy every glyph of font into 1 image, tinted with color
+bool text_atlas_load(text_atlas_t* atlas, pntr_font* font, pntr_color color) {
+    memset(atlas, 0, sizeof(text_atlas_t));
+    memset(atlas->lookup, 0xFF, sizeof(atlas->lookup));
+    if (font == NULL || font->atlas == NULL || font->charactersLen <= 0) {
+        return false;
+    }
+
+    // glyphs go in 1 row (the default font is 95 glyphs of 8x8, so that's small)
+    int width = 0;
+    int height = 1;
+    for (int i = 0; i < font->charactersLen; i++) {
+        width += font->srcRects[i].width;
+        height = MAX(height, font->srcRects[i].height);
+    }
+    atlas->image = pntr_gen_image_color(MAX(width, 1), height, PNTR_BLANK);
+    atlas->glyphs = pntr_load_memory(sizeof(text_glyph_t) * font->charactersLen);
+    if (atlas->image == NULL || atlas->glyphs == NULL) {
+        return false;
+    }
+    atlas->glyph_count = font->charactersLen;
+
+    int x = 0;
+    for (int i = 0; i < font->charactersLen; i++) {
+        text_glyph_t* glyph = &atlas->glyphs[i];
+        pntr_rectangle src = font->srcRects[i];
+        pntr_draw_image_tint_rec(atlas->image, font->atlas, src, x, 0, color);
+        glyph->src = (pntr_rectangle) { x, 0, src.width, src.height };
+        glyph->x = (int16_t)font->glyphRects[i].x;
+        glyph->y = (int16_t)font->glyphRects[i].y;
+        glyph->advance = (int16_t)(font->glyphRects[i].x + font->glyphRects[i].width);
+        glyph->blit = adventure_blit_classify(atlas->image, glyph->src);
+        atlas->line_height = MAX(atlas->line_height, font->glyphRects[i].y + font->glyphRects[i].height);
+        atlas->lookup[(unsigned char)font->characters[i]] = (int16_t)i;
+        x += src.width;
+    }
+    return true;
+}
+
+void text_atlas_unload(text_atlas_t* atlas) {
+    if (atlas->image != NULL) {
+        pntr_unload_image(atlas->image);
+    }
+    if (atlas->glyphs != NULL) {
+        pntr_unload_memory(atlas->glyphs);
+    }
+    memset(atlas, 0, sizeof(text_atlas_t));
+}
+
+static int text_word_width(text_atlas_t* atlas, const char* text) {
+    int width = 0;
+    for (; *text != 0 && *text != ' ' && *text != '\n'; text++) {
+        int16_t g = atlas->lookup[(unsigned char)*text];
+        width += g == -1 ? 0 : atlas->glyphs[g].advance;
+    }
+    return width;
+}
+
+// lay out text (re-using layout's memory), wrapped at spaces to fit width (0 to only break at \n)
+void text_layout_build(text_layout_t* layout, text_atlas_t* atlas, const char* text, int width) {
+    layout->count = 0;
+    layout->width = 0;
+    layout->height = 0;
+    if (text == NULL || atlas->glyphs == NULL) {
+        return;
+    }
+    size_t len = PNTR_STRLEN(text);
+    if ((size_t)layout->capacity < len) {
+        if (layout->placed != NULL) {
+            pntr_unload_memory(layout->placed);
+        }
+        layout->capacity = (int)MAX(len, 16);
+        layout->placed = pntr_load_memory(sizeof(text_placed_t) * layout->capacity);
+        if (layout->placed == NULL) {
+            layout->capacity = 0;
+            return;
+        }
+    }
+
+    int x = 0;
+    int y = 0;
+    for (const char* c = text; *c != 0; c++) {
+        // wrap before a word that doesn't fit (a word wider than the line still goes on its own line)
+        if (width > 0 && (c == text || c[-1] == ' ') && *c != ' ' && *c != '\n' && x > 0 && x + text_word_width(atlas, c) > width) {
+            x = 0;
+            y += atlas->line_height;
+        }
+        if (*c == '\n') {
+            x = 0;
+            y += atlas->line_height;
+            continue;
+        }
+        int16_t g = atlas->lookup[(unsigned char)*c];
+        if (g == -1) {
+            continue;
+        }
+        text_glyph_t* glyph = &atlas->glyphs[g];
+        text_placed_t* placed = &layout->placed[layout->count++];
+        placed->x = (int16_t)(x + glyph->x);
+        placed->y = (int16_t)(y + glyph->y);
+        placed->glyph = g;
+        x += glyph->advance;
+        layout->width = MAX(layout->width, x);
+    }
+    layout->height = y + atlas->line_height;
+}
+
+void text_layout_unload(text_layout_t* layout) {
+    if (layout->placed != NULL) {
+        pntr_unload_memory(layout->placed);
+    }
+    memset(layout, 0, sizeof(text_layout_t));
+}
+
+// draw a layout with its top-left at x/y
+void text_layout_draw(pntr_image* dst, text_atlas_t* atlas, text_layout_t* layout, int x, int y) {
+    if (dst == NULL || layout == NULL) {
+        return;
+    }
+    for (int i = 0; i < layout->count; i++) {
+        text_placed_t* placed = &layout->placed[i];
+        text_glyph_t* glyph = &atlas->glyphs[placed->glyph];
+        adventure_blit(dst, atlas->image, glyph->src, x + placed->x, y + placed->y, (adventure_blit_kind_t)glyph->blit, PNTR_WHITE);
+    }
+}
+
+// AssetLoadFn for asset_cache_t of layouts (userdata is the text_atlas_t), key is "WIDTH:TEXT"
+void* text_cache_layout_load(const char* key, void* userdata, size_t* bytes) {
+    char* text = NULL;
+    int width = (int)strtol(key, &text, 10);
+    if (text == NULL || *text != ':') {
+        return NULL;
+    }
+    text_layout_t* layout = pntr_load_memory(sizeof(text_layout_t));
+    if (layout == NULL) {
+        return NULL;
+    }
+    memset(layout, 0, sizeof(text_layout_t));
+    text_layout_build(layout, (text_atlas_t*)userdata, text + 1, width);
+    *bytes = sizeof(text_layout_t) + sizeof(text_placed_t) * layout->capacity;
+    return layout;
+}
+
+// AssetUnloadFn for asset_cache_t of layouts
+void text_cache_layout_unload(void* data, void* userdata) {
+    if (data != NULL) {
+        text_layout_unload((text_layout_t*)data);
+        pntr_unload_memory(data);
+    }
+}
+
+// set up an atlas for font in color, & a cache of its layouts
+bool text_cache_init(text_cache_t* cache, pntr_font* font, pntr_color color) {
+    bool loaded = text_atlas_load(&cache->atlas, font, color);
+    asset_cache_init(&cache->layouts, 16, TEXT_CACHE_BUDGET, text_cache_layout_load, text_cache_layout_unload, &cache->atlas);
+    return loaded;
+}
+
+// get a stable handle for text wrapped to width (0 to only break at \n), without laying it out
+asset_handle_t text_cache_intern(text_cache_t* cache, const char* text, int width) {
+    if (cache == NULL || text == NULL) {
+        return 0;
+    }
+    char small[256];
+    size_t size = PNTR_STRLEN(text) + 16;
+    char* key = size <= sizeof(small) ? small : pntr_load_memory(size);
+    if (key == NULL) {
+        return 0;
+    }
+    snprintf(key, size, "%d:%s", width, text);
+    asset_handle_t handle = asset_cache_intern(&cache->layouts, key);
+    if (key != small) {
+        pntr_unload_memory(key);
+    }
+    return handle;
+}
+
+// draw interned text with its top-left at x/y (laid out the first time, or if it was evicted)
+void text_cache_draw(pntr_image* dst, text_cache_t* cache, asset_handle_t handle, int x, int y) {
+    text_layout_draw(dst, &cache->atlas, asset_cache_get(&cache->layouts, handle), x, y);
+}
+
+// intern & draw, for text that isn't known ahead of time (like dialogs from map-properties)
+void text_cache_draw_text(pntr_image* dst, text_cache_t* cache, const char* text, int width, int x, int y) {
+    text_cache_draw(dst, cache, text_cache_intern(cache, text, width), x, y);
+}
+
+// free the atlas & every layout
+void text_cache_free(text_cache_t* cache) {
+    asset_cache_free(&cache->layouts);
+    text_atlas_unload(&cache->atlas);
+}
@@ -0,0 +1,58 @@
+// bakes Tiled maps (.tmj, and the .tsj tilesets they use) into .lopb blobs, that the game can mmap & use in place
+// usage: lop_bake [-o OUT.lopb] assets/main.tmj [[-o OUT.lopb] assets/dungeon1.tmj ...]
+// each map is written next to itself (assets/main.lopb), or to the -o path before it, see src/adventure_bake.h for the format
+
+#define PNTR_IMPLEMENTATION
+#define PNTR_TILED_IMPLEMENTATION
+
+#include <stdio.h>
+#include <string.h>
+
+#include "pntr.h"
+#include "pntr_tiled.h"
+
+#include "../src/adventure_bake.h"
+
+int main(int argc, char* argv[]) {
+    if (argc < 2) {
+        fprintf(stderr, "usage: %s [-o OUT.lopb] MAP.tmj...\n", argv[0]);
+        return 1;
+    }
+
+    int failed = 0;
+    const char* outArg = NULL;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-o") == 0 && i + 1 < argc) {
+            outArg = argv[++i];
+            continue;
+        }
+
+        size_t size = 0;
+        unsigned char* blob = adventure_bake_tiled(argv[i], &size);
+        if (blob == NULL) {
+            fprintf(stderr, "%s: could not bake\n", argv[i]);
+            failed++;
+            continue;
+        }
+
+        char out[PNTR_PATH_MAX];
+        if (outArg != NULL) {
+            snprintf(out, sizeof(out), "%s", outArg);
+            outArg = NULL;
+        } else {
+            adventure_bake_path(argv[i], out, sizeof(out));
+        }
+        FILE* f = fopen(out, "wb");
+        if (f == NULL || fwrite(blob, 1, size, f) != size) {
+            fprintf(stderr, "%s: could not write\n", out);
+            failed++;
+        } else {
+            printf("%s -> %s (%zu bytes)\n", argv[i], out, size);
+        }
+        if (f != NULL) {
+            fclose(f);
+        }
+        pntr_unload_memory(blob);
+    }
+    return failed ? 1 : 0;
+}
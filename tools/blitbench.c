@@ -0,0 +1,140 @@
+// blitter microbenchmark: fills an offscreen image with 16x16 tiles, using pntr's generic draw and each
+// implementation in src/adventure_blit.h (that this CPU can run), for each kind of tile
+// usage: lop_blitbench [--width W] [--height H] [--frames N]
+// reports time per frame & per tile, speed-up over pntr, and the biggest difference from pntr (per channel)
+
+#define _POSIX_C_SOURCE 200809L
+#define PNTR_IMPLEMENTATION
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "pntr.h"
+
+#include "../src/adventure_blit.h"
+
+#define BLITBENCH_TILE 16
+
+static double blitbench_now() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+typedef struct blitbench_case_t {
+    const char* name;
+    int tile;           // which tile in the atlas
+    pntr_color tint;
+} blitbench_case_t;
+
+// 3 tiles: opaque, 1-bit alpha (a round sprite) & soft alpha (a gradient)
+static pntr_image* blitbench_atlas() {
+    pntr_image* atlas = pntr_gen_image_color(BLITBENCH_TILE * 3, BLITBENCH_TILE, PNTR_BLANK);
+    for (int y = 0; y < BLITBENCH_TILE; y++) {
+        for (int x = 0; x < BLITBENCH_TILE; x++) {
+            int dx = x * 2 - BLITBENCH_TILE + 1;
+            int dy = y * 2 - BLITBENCH_TILE + 1;
+            unsigned char v = (unsigned char)(x * 16 + y);
+            pntr_draw_point(atlas, x, y, pntr_new_color(v, 255 - v, 128, 255));
+            if (dx * dx + dy * dy < BLITBENCH_TILE * BLITBENCH_TILE) {
+                pntr_draw_point(atlas, BLITBENCH_TILE + x, y, pntr_new_color(255, v, 64, 255));
+            }
+            pntr_draw_point(atlas, BLITBENCH_TILE * 2 + x, y, pntr_new_color(64, v, 255, (unsigned char)(y * 16 + 8)));
+        }
+    }
+    return atlas;
+}
+
+// draw a frame of tiles, with pntr (generic) or adventure_blit
+static void blitbench_frame(pntr_image* screen, pntr_image* atlas, blitbench_case_t* c, adventure_blit_kind_t kind, bool generic) {
+    pntr_clear_background(screen, PNTR_DARKGRAY);
+    pntr_rectangle src = { c->tile * BLITBENCH_TILE, 0, BLITBENCH_TILE, BLITBENCH_TILE };
+    for (int y = 0; y < screen->height; y += BLITBENCH_TILE) {
+        for (int x = 0; x < screen->width; x += BLITBENCH_TILE) {
+            if (!generic) {
+                adventure_blit(screen, atlas, src, x, y, kind, c->tint);
+            } else if (c->tint.value == PNTR_WHITE.value) {
+                pntr_draw_image_rec(screen, atlas, src, x, y);
+            } else {
+                pntr_draw_image_tint_rec(screen, atlas, src, x, y, c->tint);
+            }
+        }
+    }
+}
+
+static int blitbench_diff(pntr_image* a, pntr_image* b) {
+    int diff = 0;
+    for (int i = 0; i < a->width * a->height; i++) {
+        for (int shift = 0; shift < 32; shift += 8) {
+            int d = abs((int)((a->data[i].value >> shift) & 0xFF) - (int)((b->data[i].value >> shift) & 0xFF));
+            diff = d > diff ? d : diff;
+        }
+    }
+    return diff;
+}
+
+int main(int argc, char* argv[]) {
+    int width = 320;
+    int height = 240;
+    int frames = 2000;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--width") == 0 && i + 1 < argc) {
+            width = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--height") == 0 && i + 1 < argc) {
+            height = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--frames") == 0 && i + 1 < argc) {
+            frames = atoi(argv[++i]);
+        } else {
+            fprintf(stderr, "usage: %s [--width W] [--height H] [--frames N]\n", argv[0]);
+            return 1;
+        }
+    }
+    if (width <= 0 || height <= 0 || frames <= 0) {
+        return 1;
+    }
+
+    pntr_image* atlas = blitbench_atlas();
+    pntr_image* screen = pntr_gen_image_color(width, height, PNTR_BLACK);
+    pntr_image* expected = pntr_gen_image_color(width, height, PNTR_BLACK);
+    int tiles = ((width + BLITBENCH_TILE - 1) / BLITBENCH_TILE) * ((height + BLITBENCH_TILE - 1) / BLITBENCH_TILE);
+
+    blitbench_case_t cases[] = {
+        { "opaque", 0, PNTR_WHITE },
+        { "mask", 1, PNTR_WHITE },
+        { "alpha", 2, PNTR_WHITE },
+        { "tinted", 1, pntr_new_color(255, 200, 150, 160) }
+    };
+
+    printf("%dx%d, %d tiles per frame, %d frames, best here: %s\n", width, height, tiles, frames, adventure_blit_name());
+    for (int c = 0; c < (int)(sizeof(cases) / sizeof(cases[0])); c++) {
+        pntr_rectangle src = { cases[c].tile * BLITBENCH_TILE, 0, BLITBENCH_TILE, BLITBENCH_TILE };
+        adventure_blit_kind_t kind = adventure_blit_classify(atlas, src);
+
+        double start = blitbench_now();
+        for (int f = 0; f < frames; f++) {
+            blitbench_frame(expected, atlas, &cases[c], kind, true);
+        }
+        double generic = (blitbench_now() - start) / frames;
+        printf("%-7s pntr     %8.3f ms/frame %7.1f ns/tile\n", cases[c].name, generic * 1000, generic / tiles * 1e9);
+
+        for (int r = 0; r < ADVENTURE_BLIT_ALL_COUNT; r++) {
+            if (!adventure_blit_use(adventure_blit_all[r].name)) {
+                continue;
+            }
+            start = blitbench_now();
+            for (int f = 0; f < frames; f++) {
+                blitbench_frame(screen, atlas, &cases[c], kind, false);
+            }
+            double time = (blitbench_now() - start) / frames;
+            printf("%-7s %-8s %8.3f ms/frame %7.1f ns/tile %6.2fx  max diff %d\n", cases[c].name, adventure_blit_all[r].name, time * 1000, time / tiles * 1e9, generic / time, blitbench_diff(screen, expected));
+        }
+        adventure_blit_use(NULL);
+    }
+
+    pntr_unload_image(expected);
+    pntr_unload_image(screen);
+    pntr_unload_image(atlas);
+    return 0;
+}
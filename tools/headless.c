@@ -0,0 +1,331 @@
+// headless benchmark: runs the game (src/main.c) without a window or audio, against an offscreen image, with scripted input
+// usage (from repo-root, so assets/ can be found):
+//   lop_headless [--frames N] [--tick HZ] [--seed N] [--threads N] [--script "S2 R60 D60 L60 U60"] [MAP]
+//   lop_headless --replay FILE [--frames N] [--threads N]
+// the script is a list of KEY+FRAMES that loops (U/D/L/R = arrows, S = space, W = nothing)
+// every frame is a fixed 1/60s & random is seeded, so runs are repeatable, but it goes as fast as it can
+// --replay plays back a session recorded with `lop --record FILE` instead (with the frame-lengths it had), until it ends
+// reports per-frame time (split into simulation, collision & drawing), map-load time & allocations
+
+#define _POSIX_C_SOURCE 200809L
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <stdarg.h>
+#include <stdbool.h>
+#include <time.h>
+#include <limits.h>
+
+// count allocations made through pntr (& everything that uses pntr_load_memory)
+static uint64_t headless_allocs = 0;
+static uint64_t headless_alloc_bytes = 0;
+static uint64_t headless_frees = 0;
+
+static void* headless_malloc(size_t size) {
+    headless_allocs++;
+    headless_alloc_bytes += size;
+    return malloc(size);
+}
+
+static void headless_free(void* ptr) {
+    if (ptr != NULL) {
+        headless_frees++;
+    }
+    free(ptr);
+}
+
+#define PNTR_MALLOC(size) headless_malloc((size_t)(size))
+#define PNTR_FREE(obj) headless_free((void*)(obj))
+
+static double headless_now() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+// timing zones (see ADVENTURE_ZONE_BEGIN in adventure.h)
+typedef enum headless_zone_t {
+    HEADLESS_ZONE_SIM = 0,
+    HEADLESS_ZONE_COMMANDS,
+    HEADLESS_ZONE_MOVE,
+    HEADLESS_ZONE_NPC,
+    HEADLESS_ZONE_INTENTS,
+    HEADLESS_ZONE_COLLISION,
+    HEADLESS_ZONE_ANIMATE,
+    HEADLESS_ZONE_DRAW,
+    HEADLESS_ZONE_LOAD,
+    HEADLESS_ZONE_COUNT
+} headless_zone_t;
+
+static const char* headless_zone_names[HEADLESS_ZONE_COUNT] = { "simulation", "commands", "move", "npc", "intents", "collision", "animate", "draw", "load" };
+static _Thread_local double headless_zone_start[HEADLESS_ZONE_COUNT];
+static double headless_zone_time[HEADLESS_ZONE_COUNT];  // this frame
+static uint64_t headless_zone_calls[HEADLESS_ZONE_COUNT];
+
+// only timed on main thread (collision-checks in NPC jobs are counted as simulation)
+static _Thread_local bool headless_main_thread = false;
+
+#define ADVENTURE_ZONE_BEGIN(zone) (headless_main_thread ? (headless_zone_start[HEADLESS_ZONE_##zone] = headless_now()) : 0)
+#define ADVENTURE_ZONE_END(zone) (headless_main_thread ? (headless_zone_time[HEADLESS_ZONE_##zone] += headless_now() - headless_zone_start[HEADLESS_ZONE_##zone], headless_zone_calls[HEADLESS_ZONE_##zone]++) : 0)
+
+// load maps on main thread, so load-time is counted & runs are repeatable
+#define ADVENTURE_PREFETCH_NO_THREADS
+
+#define LOP_HEADLESS
+#define PNTR_IMPLEMENTATION
+#include "../src/main.c"
+
+
+// windowless pntr_app: scripted keys, fixed delta-time, seeded random & silent sounds
+
+static pntr_app_key headless_key = 0;
+static float headless_dt = 1.0f / 60.0f;
+static uint32_t headless_random_state = 1;
+
+float pntr_app_delta_time(pntr_app* app) {
+    return headless_dt;
+}
+
+bool pntr_app_key_down(pntr_app* app, pntr_app_key key) {
+    return headless_key != 0 && key == headless_key;
+}
+
+bool pntr_app_gamepad_button_down(pntr_app* app, int gamepad, pntr_app_gamepad_button button) {
+    return false;
+}
+
+// xorshift32
+static uint32_t headless_random() {
+    uint32_t x = headless_random_state;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    return headless_random_state = x;
+}
+
+int pntr_app_random(pntr_app* app, int min, int max) {
+    if (max <= min) {
+        return min;
+    }
+    return min + (int)(headless_random() % (uint32_t)(max - min + 1));
+}
+
+float pntr_app_random_float(pntr_app* app, float min, float max) {
+    return min + (headless_random() / (float)UINT32_MAX) * (max - min);
+}
+
+void pntr_app_log(pntr_app_log_type type, const char* message) {
+    if (type == PNTR_APP_LOG_WARNING || type == PNTR_APP_LOG_ERROR) {
+        fprintf(stderr, "%s\n", message);
+    }
+}
+
+void pntr_app_log_ex(pntr_app_log_type type, const char* message, ...) {
+    if (type == PNTR_APP_LOG_WARNING || type == PNTR_APP_LOG_ERROR) {
+        va_list args;
+        va_start(args, message);
+        vfprintf(stderr, message, args);
+        va_end(args);
+        fprintf(stderr, "\n");
+    }
+}
+
+// sounds are never played, this just has to be something that isn't NULL
+static char headless_sound;
+
+pntr_sound* pntr_load_sound(const char* fileName) {
+    return (pntr_sound*)&headless_sound;
+}
+
+pntr_sound* pntr_load_sound_from_memory(pntr_app_sound_type type, unsigned char* data, unsigned int dataSize) {
+    return (pntr_sound*)&headless_sound;
+}
+
+void pntr_play_sound(pntr_sound* sound, bool loop) {}
+void pntr_stop_sound(pntr_sound* sound) {}
+void pntr_unload_sound(pntr_sound* sound) {}
+
+
+// script
+
+typedef struct headless_step_t {
+    pntr_app_key key;
+    int frames;
+} headless_step_t;
+
+static int headless_parse_script(const char* script, headless_step_t* steps, int max) {
+    int count = 0;
+    const char* c = script;
+    while (*c && count < max) {
+        while (*c == ' ' || *c == ',') {
+            c++;
+        }
+        if (!*c) {
+            break;
+        }
+        pntr_app_key key = 0;
+        switch (*c) {
+            case 'U': key = PNTR_APP_KEY_UP; break;
+            case 'D': key = PNTR_APP_KEY_DOWN; break;
+            case 'L': key = PNTR_APP_KEY_LEFT; break;
+            case 'R': key = PNTR_APP_KEY_RIGHT; break;
+            case 'S': key = PNTR_APP_KEY_SPACE; break;
+            case 'W': key = 0; break;
+            default:
+                fprintf(stderr, "bad script key '%c'\n", *c);
+                return 0;
+        }
+        c++;
+        int frames = (int)strtol(c, (char**)&c, 10);
+        steps[count].key = key;
+        steps[count].frames = frames > 0 ? frames : 1;
+        count++;
+    }
+    return count;
+}
+
+static int headless_compare_double(const void* a, const void* b) {
+    double da = *(const double*)a;
+    double db = *(const double*)b;
+    return (da > db) - (da < db);
+}
+
+int main(int argc, char* argv[]) {
+    headless_main_thread = true;
+    int frames = 0;
+    const char* script = "S2 R90 S1 D90 S1 L90 S1 U90";
+    char* map = NULL;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--frames") == 0 && i + 1 < argc) {
+            frames = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--tick") == 0 && i + 1 < argc) {
+            tick_rate = (float)atof(argv[++i]);
+        } else if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc) {
+            random_seed = strtoull(argv[++i], NULL, 10);
+            headless_random_state = (uint32_t)random_seed;
+            if (headless_random_state == 0) {
+                headless_random_state = 1;
+            }
+        } else if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+            job_threads = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--replay") == 0 && i + 1 < argc) {
+            replay_file = argv[++i];
+        } else if (strcmp(argv[i], "--script") == 0 && i + 1 < argc) {
+            script = argv[++i];
+        } else if (argv[i][0] == '-') {
+            fprintf(stderr, "usage: %s [--frames N] [--tick HZ] [--seed N] [--threads N] [--script \"S2 R60 D60\"] [--replay FILE] [MAP]\n", argv[0]);
+            return 1;
+        } else {
+            map = argv[i];
+        }
+    }
+
+    headless_step_t steps[256];
+    int step_count = headless_parse_script(script, steps, 256);
+    if (step_count == 0 || frames < 0) {
+        return 1;
+    }
+    if (frames == 0) {
+        frames = replay_file != NULL ? INT_MAX : 3600;
+    }
+
+    // replay_file is set directly, Main just gets the map
+    char* main_argv[2] = { argv[0], map };
+    pntr_app app = Main(map ? 2 : 1, main_argv);
+    pntr_image* screen = pntr_gen_image_color(app.width, app.height, PNTR_BLACK);
+
+    double init_start = headless_now();
+    if (!app.init(&app)) {
+        fprintf(stderr, "init failed\n");
+        return 1;
+    }
+    if (replay_file != NULL && recording.mode != INPUT_RECORD_READ) {
+        return 1;
+    }
+    char start_map[PNTR_PATH_MAX] = {0};
+    strncpy(start_map, startMap, PNTR_PATH_MAX - 1);
+    double init_time = headless_now() - init_start;
+    double init_load_time = headless_zone_time[HEADLESS_ZONE_LOAD];
+    uint64_t init_allocs = headless_allocs;
+    uint64_t init_alloc_bytes = headless_alloc_bytes;
+
+    int frame_capacity = MIN(frames, 1 << 16);
+    double* frame_times = malloc(sizeof(double) * frame_capacity);
+    double game_time = 0;
+    double zone_total[HEADLESS_ZONE_COUNT] = {0};
+    double zone_max[HEADLESS_ZONE_COUNT] = {0};
+    double load_total = init_load_time;
+    uint64_t loads_before = headless_zone_calls[HEADLESS_ZONE_LOAD];
+
+    int step = 0;
+    int step_frame = 0;
+    double run_start = headless_now();
+    int f = 0;
+    for (; f < frames; f++) {
+        headless_key = steps[step].key;
+        if (++step_frame >= steps[step].frames) {
+            step_frame = 0;
+            step = (step + 1) % step_count;
+        }
+
+        memset(headless_zone_time, 0, sizeof(headless_zone_time));
+        double start = headless_now();
+        app.update(&app, screen);
+        double time = headless_now() - start;
+
+        // the last frame of a replay has nothing recorded, so it's not counted
+        if (replay_file != NULL && recording.mode != INPUT_RECORD_READ) {
+            break;
+        }
+        game_time += replay_file != NULL ? recording.last_dt : headless_dt;
+        if (f == frame_capacity) {
+            frame_capacity *= 2;
+            frame_times = realloc(frame_times, sizeof(double) * frame_capacity);
+        }
+        frame_times[f] = time;
+
+        for (int z = 0; z < HEADLESS_ZONE_COUNT; z++) {
+            zone_total[z] += headless_zone_time[z];
+            zone_max[z] = headless_zone_time[z] > zone_max[z] ? headless_zone_time[z] : zone_max[z];
+        }
+        load_total += headless_zone_time[HEADLESS_ZONE_LOAD];
+    }
+    double run_time = headless_now() - run_start;
+    frames = f;
+    if (frames == 0) {
+        fprintf(stderr, "no frames\n");
+        return 1;
+    }
+    uint64_t frame_allocs = headless_allocs - init_allocs;
+    uint64_t frame_alloc_bytes = headless_alloc_bytes - init_alloc_bytes;
+    uint64_t frame_loads = headless_zone_calls[HEADLESS_ZONE_LOAD] - loads_before;
+
+    int threads = jobs.thread_count;
+    app.close(&app);
+    pntr_unload_image(screen);
+
+    double frame_sum = 0;
+    for (f = 0; f < frames; f++) {
+        frame_sum += frame_times[f];
+    }
+    qsort(frame_times, frames, sizeof(double), headless_compare_double);
+
+    printf("map:         %s%s%s\n", start_map, replay_file ? ", replaying " : "", replay_file ? replay_file : "");
+    printf("frames:      %d (%.2fs of game at %.0f ticks/s) in %.3fs, %.0f frames/s\n", frames, game_time, tick_rate, run_time, frames / run_time);
+    printf("threads:     %d\n", threads);
+    printf("init:        %.3f ms (%.3f ms loading maps)\n", init_time * 1000, init_load_time * 1000);
+    printf("frame:       avg %.3f ms, median %.3f ms, p99 %.3f ms, max %.3f ms\n", frame_sum / frames * 1000, frame_times[frames / 2] * 1000, frame_times[(int)(frames * 0.99)] * 1000, frame_times[frames - 1] * 1000);
+    for (int z = 0; z < HEADLESS_ZONE_LOAD; z++) {
+        printf("  %-11s avg %.3f ms, max %.3f ms\n", headless_zone_names[z], zone_total[z] / frames * 1000, zone_max[z] * 1000);
+    }
+    printf("map loads:   %llu (%.3f ms total, %llu during frames)\n", (unsigned long long)headless_zone_calls[HEADLESS_ZONE_LOAD], load_total * 1000, (unsigned long long)frame_loads);
+    printf("allocations: %llu in init (%.1f KB), %llu during frames (%.1f KB, %.2f per frame), %llu frees\n",
+        (unsigned long long)init_allocs, init_alloc_bytes / 1024.0,
+        (unsigned long long)frame_allocs, frame_alloc_bytes / 1024.0, (double)frame_allocs / frames,
+        (unsigned long long)headless_frees);
+
+    free(frame_times);
+    return 0;
+}